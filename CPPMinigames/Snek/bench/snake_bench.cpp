@@ -0,0 +1,261 @@
+// Microbenchmarks for the simulation hot paths. Each case is run over a set
+// of board sizes, board fills (snake length) and apple counts, and reports ns/op and heap
+// allocations per op. Use --json to get machine-readable results for
+// comparing builds.
+//
+// Usage: snake_bench [--filter <substring>] [--min-time <ms>] [--json <file>]
+
+#include "game_state.h"
+#include "game_logic.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// Count every heap allocation so each case can report allocations per op
+static uint64_t allocationCount = 0;
+
+void* operator new(std::size_t size) {
+    allocationCount++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    // Keeps results alive so the optimizer can't drop the measured calls
+    volatile int sink = 0;
+
+    struct BenchParams {
+        int boardSize;
+        int snakeLength;
+        int appleCount;
+    };
+
+    struct BenchResult {
+        std::string name;
+        BenchParams params;
+        uint64_t ops;
+        double nsPerOp;
+        double allocsPerOp;
+    };
+
+    // Ops run back to back between fixture restores (restores are not timed);
+    // bigger boards use bigger batches so copying the fixture doesn't dominate
+    int BatchSize(const BenchParams& params) {
+        return std::max(256, params.boardSize * params.boardSize / 64);
+    }
+
+    // Lays the snake along a boustrophedon path from the top-left corner with
+    // the head at the end, then spawns apples on the remaining free cells.
+    // Effects are set so movement can wrap and cross the body indefinitely.
+    GameState MakeFixture(const BenchParams& params, GameMode mode) {
+        const int width = params.boardSize;
+        GameState state;
+        state.SetBoardSize(params.boardSize, params.boardSize);
+        state.Initialize(12345);
+        state.gameMode = mode;
+        state.showModeSelection = false;
+        state.ClearBoard();
+        state.snake.reserve(width * width + BatchSize(params) * 2);
+        state.apples.reserve(GameConstants::MAX_APPLES);
+
+        for (int i = params.snakeLength - 1; i >= 0; i--) {
+            int row = i / width;
+            int col = i % width;
+            if (row % 2 != 0) {
+                col = width - 1 - col;
+            }
+            state.PushTail({col, row});
+        }
+        for (int i = 0; i < params.appleCount; i++) {
+            state.SpawnApple(0);
+        }
+        // Cancel the despawns so the apple count stays put
+        for (auto& apple : state.apples) {
+            state.gameTimers.Cancel(apple.despawnTimer);
+        }
+
+        int headRow = (params.snakeLength - 1) / width;
+        state.dx = (headRow % 2 == 0) ? 1 : -1;
+        state.dy = 0;
+        state.canIntersectSelf = true;
+        state.StartTimer(TIMER_IMMUNITY, GameConstants::IMMUNITY_DURATION);
+        state.canPassWalls = true;
+        state.StartTimer(TIMER_WALL_IMMUNITY, GameConstants::WALL_IMMUNITY_DURATION);
+        return state;
+    }
+
+    // Runs op in timed batches until minTime has elapsed, restoring the
+    // working state from the fixture (untimed) before each batch
+    template <typename Op>
+    BenchResult Run(const char* name, const BenchParams& params, GameMode mode, double minTime, Op op) {
+        const GameState fixture = MakeFixture(params, mode);
+        GameState state = fixture;
+        const int batchSize = BatchSize(params);
+
+        // Warm-up batch so container capacities settle before measuring
+        for (int i = 0; i < batchSize; i++) {
+            op(state, i);
+        }
+
+        uint64_t ops = 0;
+        uint64_t allocations = 0;
+        double seconds = 0.0;
+        while (seconds < minTime) {
+            state = fixture;
+            uint64_t allocationsBefore = allocationCount;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < batchSize; i++) {
+                op(state, i);
+            }
+            auto end = std::chrono::steady_clock::now();
+            allocations += allocationCount - allocationsBefore;
+            seconds += std::chrono::duration<double>(end - start).count();
+            ops += batchSize;
+        }
+
+        BenchResult result;
+        result.name = name;
+        result.params = params;
+        result.ops = ops;
+        result.nsPerOp = seconds * 1e9 / ops;
+        result.allocsPerOp = (double)allocations / ops;
+        return result;
+    }
+
+    void ProcessMovementOp(GameState& state, int) {
+        // Force a move every call; poison pauses and teleports stop the snake, so undo those
+        state.moveTimer = GameConstants::MOVE_INTERVAL_REGULAR;
+        state.isPaused = false;
+        if (state.dx == 0 && state.dy == 0) {
+            state.dx = 1;
+        }
+        GameLogic::ProcessMovement(state);
+    }
+
+    void CheckCollisionsOp(GameState& state, int) {
+        if (state.dx == 0 && state.dy == 0) {
+            state.dx = 1;
+        }
+        Position head = state.snake.front();
+        Position newHead = {(head.col + state.dx + state.boardWidth) % state.boardWidth,
+                            (head.row + state.dy + state.boardHeight) % state.boardHeight};
+        GameLogic::CheckCollisions(state, newHead);
+    }
+
+    void SpawnAppleOp(GameState& state, int) {
+        // Remove one then spawn one, so the apple count stays at the fixture's
+        state.RemoveApple((int)state.apples.size() - 1);
+        state.SpawnApple(state.gameTicks);
+    }
+
+    void IsValidPositionOp(GameState& state, int i) {
+        // Stride through the board so lookups aren't all the same cell
+        int cell = (int)(((int64_t)i * 7919) % (state.boardWidth * state.boardHeight));
+        sink += state.IsValidPosition(cell % state.boardWidth, cell / state.boardWidth);
+    }
+
+    void UpdateAppleDespawnOp(GameState& state, int) {
+        // Despawns fire from the timer wheel, so advance it along with the clock
+        state.gameTicks++;
+        state.UpdateStatusEffects();
+        state.UpdateAppleDespawn();
+    }
+
+    void WriteJson(FILE* out, const std::vector<BenchResult>& results) {
+        std::fprintf(out, "{\n");
+        std::fprintf(out, "  \"benchmarks\": [\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            std::fprintf(out, "    {\"name\": \"%s\", \"board\": %d, \"snake_length\": %d, \"apples\": %d, "
+                         "\"ops\": %llu, \"ns_per_op\": %.3f, \"allocs_per_op\": %.4f}%s\n",
+                         r.name.c_str(), r.params.boardSize, r.params.snakeLength, r.params.appleCount,
+                         (unsigned long long)r.ops, r.nsPerOp, r.allocsPerOp,
+                         (i + 1 < results.size()) ? "," : "");
+        }
+        std::fprintf(out, "  ]\n}\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    double minTime = 0.1;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minTime = std::atof(argv[++i]) / 1000.0;
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            std::fprintf(stderr, "Usage: %s [--filter <substring>] [--min-time <ms>] [--json <file>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Square boards from the default size up to a mega board, each filled
+    // from a fresh game up to nearly full (a couple of cells left free)
+    const int boardSizes[] = {GameConstants::GRID_WIDTH, 256, 1024};
+    const int appleCounts[] = {1, GameConstants::MAX_APPLES};
+    std::vector<BenchParams> paramSets;
+    for (int size : boardSizes) {
+        const int cells = size * size;
+        for (int apples : appleCounts) {
+            const int fills[] = {3, cells / 4, cells / 2, cells / 10 * 9, cells - apples - 2};
+            for (int length : fills) {
+                paramSets.push_back({size, length, apples});
+            }
+        }
+    }
+
+    struct Case {
+        const char* name;
+        GameMode mode;
+        void (*op)(GameState&, int);
+    };
+    const Case cases[] = {
+        {"ProcessMovement", MODE_REGULAR, ProcessMovementOp},
+        {"CheckCollisions", MODE_REGULAR, CheckCollisionsOp},
+        {"SpawnApple", MODE_REGULAR, SpawnAppleOp},
+        {"IsValidPosition", MODE_REGULAR, IsValidPositionOp},
+        {"UpdateAppleDespawn", MODE_ACCELERATED, UpdateAppleDespawnOp},
+    };
+
+    std::printf("%-20s %6s %8s %7s %14s %12s %14s\n", "benchmark", "board", "length", "apples", "ops", "ns/op", "allocs/op");
+    std::vector<BenchResult> results;
+    for (const Case& c : cases) {
+        if (filter && !std::strstr(c.name, filter)) {
+            continue;
+        }
+        for (const BenchParams& params : paramSets) {
+            BenchResult r = Run(c.name, params, c.mode, minTime, c.op);
+            std::printf("%-20s %6d %8d %7d %14llu %12.2f %14.4f\n", r.name.c_str(), params.boardSize, params.snakeLength,
+                        params.appleCount, (unsigned long long)r.ops, r.nsPerOp, r.allocsPerOp);
+            results.push_back(r);
+        }
+    }
+
+    if (jsonPath) {
+        FILE* out = std::fopen(jsonPath, "w");
+        if (!out) {
+            std::fprintf(stderr, "Could not write %s\n", jsonPath);
+            return 1;
+        }
+        WriteJson(out, results);
+        std::fclose(out);
+    }
+    return 0;
+}
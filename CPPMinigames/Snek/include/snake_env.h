@@ -0,0 +1,124 @@
+#ifndef SNAKE_ENV_H
+#define SNAKE_ENV_H
+
+/*
+ * Snek as a reinforcement-learning environment: a plain C API over the game
+ * rules (no raylib), in the reset(seed) / step(action) style of Gym.
+ *
+ * One step is one move of the snake: the action is queued like a key press
+ * and the simulation runs up to and including the tick the snake moves on
+ * (or the game ends), so poison pauses are skipped over. Until the first
+ * turn is chosen the snake stands still. The reward is the change in score,
+ * plus death_reward when the game ends.
+ *
+ * Observations are written into buffers the caller owns (e.g. numpy arrays),
+ * registered once with snake_env_set_buffers. The planes are only patched
+ * where the board changed, so a step costs the same on any board size:
+ *
+ *   planes   uint8_t[SNAKE_ENV_PLANE_COUNT][board_height][board_width],
+ *            row-major, 1 where the plane's feature is present, else 0
+ *   effects  float[SNAKE_ENV_EFFECT_COUNT], the fraction of each effect's
+ *            duration still to run (0 when inactive)
+ *
+ * The caller must not write to the buffers while they are registered. An
+ * environment must only be used from one thread at a time; separate
+ * environments are independent.
+ */
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#ifdef SNAKE_ENV_BUILD
+#define SNAKE_ENV_API __declspec(dllexport)
+#else
+#define SNAKE_ENV_API __declspec(dllimport)
+#endif
+#else
+#define SNAKE_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNAKE_ENV_VERSION 1
+
+typedef struct SnakeEnv SnakeEnv;
+
+enum SnakeEnvMode {
+    SNAKE_ENV_MODE_REGULAR = 0,
+    SNAKE_ENV_MODE_ACCELERATED = 1  /* Faster moves, apples despawn */
+};
+
+/* Actions; NONE keeps going straight, turning back onto the body is ignored */
+enum SnakeEnvAction {
+    SNAKE_ENV_ACTION_NONE = 0,
+    SNAKE_ENV_ACTION_UP = 1,
+    SNAKE_ENV_ACTION_DOWN = 2,
+    SNAKE_ENV_ACTION_LEFT = 3,
+    SNAKE_ENV_ACTION_RIGHT = 4,
+    SNAKE_ENV_ACTION_COUNT = 5
+};
+
+enum SnakeEnvPlane {
+    SNAKE_ENV_PLANE_BODY = 0,       /* Every segment, head included */
+    SNAKE_ENV_PLANE_HEAD = 1,
+    SNAKE_ENV_PLANE_REGULAR = 2,    /* One plane per apple type */
+    SNAKE_ENV_PLANE_POISONOUS = 3,
+    SNAKE_ENV_PLANE_POMME_PLUS = 4,
+    SNAKE_ENV_PLANE_POMME_SUPREME = 5,
+    SNAKE_ENV_PLANE_TELEPORT = 6,
+    SNAKE_ENV_PLANE_COUNT = 7
+};
+
+enum SnakeEnvEffect {
+    SNAKE_ENV_EFFECT_IMMUNITY = 0,      /* Can cross its own body */
+    SNAKE_ENV_EFFECT_WALL_IMMUNITY = 1, /* Wraps around the walls */
+    SNAKE_ENV_EFFECT_CANNOT_EAT = 2,    /* Poisoned: regular and teleport apples don't count */
+    SNAKE_ENV_EFFECT_POISON_PAUSE = 3,  /* Frozen after a poison bite */
+    SNAKE_ENV_EFFECT_COUNT = 4
+};
+
+typedef struct SnakeEnvConfig {
+    int board_width;        /* Cells; clamped to the game's limits */
+    int board_height;
+    int mode;               /* SnakeEnvMode */
+    int max_steps;          /* Truncate episodes after this many steps; 0 for no limit */
+    float death_reward;     /* Added to the reward of the step that ends the game */
+} SnakeEnvConfig;
+
+typedef struct SnakeEnvResult {
+    float reward;
+    int terminated;         /* The snake died; call snake_env_reset */
+    int truncated;          /* max_steps reached; call snake_env_reset */
+    int score;
+    int length;
+    uint32_t ticks;         /* Simulation ticks since the reset (60 per second of game time) */
+} SnakeEnvResult;
+
+/* The game's defaults: 22x22 board, regular mode, no step limit, no death reward */
+SNAKE_ENV_API void snake_env_default_config(SnakeEnvConfig* config);
+
+/* Returns NULL on allocation failure; config may be NULL for the defaults */
+SNAKE_ENV_API SnakeEnv* snake_env_create(const SnakeEnvConfig* config);
+SNAKE_ENV_API void snake_env_destroy(SnakeEnv* env);
+
+/* Board size after clamping, which sizes the planes */
+SNAKE_ENV_API int snake_env_board_width(const SnakeEnv* env);
+SNAKE_ENV_API int snake_env_board_height(const SnakeEnv* env);
+
+/* Register the observation buffers (either may be NULL); they are filled
+   right away and kept up to date by every reset and step */
+SNAKE_ENV_API void snake_env_set_buffers(SnakeEnv* env, uint8_t* planes, float* effects);
+
+/* Start a new game; the same seed and actions always play out the same way */
+SNAKE_ENV_API void snake_env_reset(SnakeEnv* env, uint64_t seed);
+
+/* Returns 0, or -1 for an invalid action or a step after the episode ended */
+SNAKE_ENV_API int snake_env_step(SnakeEnv* env, int action, SnakeEnvResult* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
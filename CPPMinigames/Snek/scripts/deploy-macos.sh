@@ -28,8 +28,9 @@ mkdir -p "$RESOURCES_DIR"
 echo "Copying executable..."
 cp build/snake "$MACOS_DIR/${APP_NAME}"
 
-echo "Copying sounds..."
-cp -r sounds "$RESOURCES_DIR/"
+echo "Copying asset pack..."
+# The game opens snake.pak from its own directory
+cp build/snake.pak "$MACOS_DIR/"
 
 echo "Creating Info.plist..."
 cat > "${CONTENTS_DIR}/Info.plist" <<EOF
@@ -57,13 +58,8 @@ cat > "${CONTENTS_DIR}/Info.plist" <<EOF
 </plist>
 EOF
 
-echo "Updating executable to use Resources/sounds..."
-# We need to update the code to look for sounds in Resources, or create a wrapper
-# For now, create a symlink
-cd "$MACOS_DIR"
-ln -sf "../Resources/sounds" sounds
-
 echo "Bundling raylib (if needed)..."
+cd "$MACOS_DIR"
 # Check if raylib is statically or dynamically linked
 if otool -L "${APP_NAME}" | grep -q libraylib; then
     echo "Dynamic linking detected - you may need to bundle raylib dylib"
@@ -45,8 +45,8 @@ mkdir -p "$DIST_DIR"
 echo "Copying executable..."
 cp "build/${EXECUTABLE}" "$DIST_DIR/"
 
-echo "Copying sounds..."
-cp -r sounds "$DIST_DIR/"
+echo "Copying asset pack..."
+cp build/snake.pak "$DIST_DIR/"
 
 echo "Creating README..."
 cat > "$DIST_DIR/README.txt" <<EOF
@@ -61,7 +61,7 @@ REQUIREMENTS:
 - Sound system (for audio)
 
 SOUND FILES:
-The sounds/ directory must be in the same folder as the executable.
+snake.pak holds the sounds and must be in the same folder as the executable.
 
 CONTROLS:
 - Arrow Keys / WASD - Move
@@ -0,0 +1,355 @@
+#include "arena.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace {
+    const Direction MOVES[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+
+    // Bots look for apples within this many cells of the head and pick a
+    // new target every GOAL_REFRESH moves (or when theirs is eaten)
+    const int GOAL_RADIUS = 8;
+    const int GOAL_REFRESH = 16;
+
+    // The grid stores apple indices as int16
+    const int MAX_ARENA_APPLES = 32767;
+
+    int Distance(Position a, Position b) {
+        return std::abs(a.col - b.col) + std::abs(a.row - b.row);
+    }
+}
+
+void Arena::Initialize(const ArenaConfig& newConfig) {
+    config = newConfig;
+    config.width = std::max(GameConstants::MIN_BOARD_SIZE, std::min(config.width, GameConstants::MAX_BOARD_SIZE));
+    config.height = std::max(GameConstants::MIN_BOARD_SIZE, std::min(config.height, GameConstants::MAX_BOARD_SIZE));
+    config.snakes = std::max(1, config.snakes);
+    config.startLength = std::max(1, config.startLength);
+    if (config.apples <= 0) {
+        config.apples = std::max(1, config.snakes / 2);
+    }
+    config.apples = std::min(config.apples, MAX_ARENA_APPLES);
+
+    // Keep the pool across restarts unless a different size was asked for
+    if (!pool || (config.threads > 0 && pool->Size() != config.threads)) {
+        pool.reset(new WorkerPool(config.threads));
+    }
+
+    size_t cells = (size_t)config.width * config.height;
+    grid.Resize(config.width, config.height);
+    rng.Seed(config.seed);
+    snakes.assign(config.snakes, ArenaSnake());
+    apples.clear();
+    apples.reserve(config.apples);
+    playerQueue.clear();
+    tick = 0;
+    aliveCount = 0;
+    wallDeaths = 0;
+    bodyDeaths = 0;
+    headOnDeaths = 0;
+
+    intents.assign(config.snakes, Position{0, 0});
+    dying.assign(config.snakes, 0);
+    claimStamp.assign(cells, 0);
+    claimCount.assign(cells, 0);
+    headOwner.assign(cells, -1);
+
+    for (int i = 0; i < config.snakes; i++) {
+        snakes[i].rng.Seed(config.seed + 0x9e3779b97f4a7c15ull * (uint64_t)(i + 1));
+        Spawn(i);
+    }
+    RefillApples();
+}
+
+void Arena::QueuePlayerDirection(Direction direction) {
+    if (config.player && playerQueue.size() < 3) {
+        playerQueue.push_back(direction);
+    }
+}
+
+void Arena::Step() {
+    tick++;
+    int count = (int)snakes.size();
+
+    // Player turns come from the queue, one per move
+    if (config.player && snakes[0].alive && !playerQueue.empty()) {
+        Direction next = playerQueue.front();
+        playerQueue.pop_front();
+        ArenaSnake& player = snakes[0];
+        bool reverses = next.dx == -player.dir.dx && next.dy == -player.dir.dy;
+        if (!reverses || player.body.size() == 1) {
+            player.dir = next;
+        }
+    }
+
+    // Phase 1 (parallel): every live snake picks the cell it moves into
+    pool->ParallelFor(count, [this](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            ArenaSnake& snake = snakes[i];
+            if (!snake.alive) {
+                continue;
+            }
+            if (i != 0 || !config.player) {
+                snake.dir = DecideBot(i);
+            }
+            Position head = snake.body.front();
+            intents[i] = {head.col + snake.dir.dx, head.row + snake.dir.dy};
+        }
+    });
+
+    // Phase 2 (serial, in snake order): resolve the moves
+    for (int i = 0; i < count; i++) {
+        dying[i] = 0;
+        if (!snakes[i].alive) {
+            continue;
+        }
+        Position target = intents[i];
+        if (!InBounds(target)) {
+            dying[i] = 1;
+            wallDeaths++;
+            continue;
+        }
+        int cell = target.row * config.width + target.col;
+        if (claimStamp[cell] != tick) {
+            claimStamp[cell] = tick;
+            claimCount[cell] = 0;
+        }
+        claimCount[cell]++;
+    }
+    for (int i = 0; i < count; i++) {
+        if (snakes[i].alive && !dying[i]) {
+            Position target = intents[i];
+            if (claimCount[target.row * config.width + target.col] > 1) {
+                dying[i] = 1;
+                headOnDeaths++;
+            }
+        }
+    }
+
+    // Tails move first, so a head may follow any tail (its own included)
+    for (int i = 0; i < count; i++) {
+        ArenaSnake& snake = snakes[i];
+        if (!snake.alive || dying[i]) {
+            continue;
+        }
+        if (snake.growth > 0) {
+            snake.growth--;
+        } else {
+            grid.RemoveSnake(snake.body.back());
+            snake.body.pop_back();
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (snakes[i].alive && !dying[i] && grid.HasSnake(intents[i].col, intents[i].row)) {
+            dying[i] = 1;
+            bodyDeaths++;
+        }
+    }
+
+    // Survivors move and eat
+    for (int i = 0; i < count; i++) {
+        ArenaSnake& snake = snakes[i];
+        if (!snake.alive || dying[i]) {
+            continue;
+        }
+        Position target = intents[i];
+        // The old head may already be gone with the tail, so step back from the target
+        int oldHead = (target.row - snake.dir.dy) * config.width + (target.col - snake.dir.dx);
+        if (headOwner[oldHead] == i) {
+            headOwner[oldHead] = -1;
+        }
+        snake.body.push_front(target);
+        grid.AddSnake(target);
+        headOwner[target.row * config.width + target.col] = i;
+        int apple = grid.AppleAt(target.col, target.row);
+        if (apple != OccupancyGrid::NO_APPLE) {
+            RemoveApple(apple);
+            snake.growth++;
+            snake.score++;
+        }
+    }
+
+    // Bots that died earlier come back before this step's dead are cleared,
+    // so nobody respawns into a cell that was occupied when it died
+    for (int i = 0; i < count; i++) {
+        ArenaSnake& snake = snakes[i];
+        if (!snake.alive && (i != 0 || !config.player) && --snake.respawnTimer <= 0) {
+            Spawn(i);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (dying[i]) {
+            Kill(i);
+        }
+    }
+
+    RefillApples();
+}
+
+Direction Arena::DecideBot(int index) {
+    ArenaSnake& snake = snakes[index];
+    Position head = snake.body.front();
+
+    // Pick the closest apple in a window around the head, nearest ring first
+    bool goalEaten = InBounds(snake.goal) && grid.AppleAt(snake.goal.col, snake.goal.row) == OccupancyGrid::NO_APPLE;
+    if (--snake.goalAge <= 0 || goalEaten) {
+        snake.goal = {-1, -1};
+        snake.goalAge = GOAL_REFRESH;
+        for (int r = 1; r <= GOAL_RADIUS && snake.goal.col < 0; r++) {
+            for (int dy = -r; dy <= r && snake.goal.col < 0; dy++) {
+                int row = head.row + dy;
+                if (row < 0 || row >= config.height) {
+                    continue;
+                }
+                // Whole rows at the top and bottom of the ring, the two ends otherwise
+                int step = (dy == -r || dy == r) ? 1 : 2 * r;
+                for (int dx = -r; dx <= r; dx += step) {
+                    int col = head.col + dx;
+                    if (col >= 0 && col < config.width && grid.AppleAt(col, row) != OccupancyGrid::NO_APPLE) {
+                        snake.goal = {col, row};
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    bool hasGoal = snake.goal.col >= 0;
+
+    int best = -1;
+    int bestScore = INT_MIN;
+    for (int d = 0; d < 4; d++) {
+        Direction move = MOVES[d];
+        if (move.dx == -snake.dir.dx && move.dy == -snake.dir.dy && snake.body.size() > 1) {
+            continue;
+        }
+        Position next = {head.col + move.dx, head.row + move.dy};
+        int score;
+        if (!InBounds(next) || grid.HasSnake(next.col, next.row)) {
+            score = -1000;
+        } else {
+            // Prefer open space, then food, then heading straight on
+            score = 0;
+            for (const Direction& around : MOVES) {
+                Position beyond = {next.col + around.dx, next.row + around.dy};
+                if (InBounds(beyond) && !grid.HasSnake(beyond.col, beyond.row)) {
+                    score += 10;
+                }
+            }
+            if (grid.AppleAt(next.col, next.row) != OccupancyGrid::NO_APPLE) {
+                score += 50;
+            }
+            // Another head next to the cell could move there too
+            if (HeadNear(next, index)) {
+                score -= 100;
+            }
+            if (hasGoal) {
+                score += 20 * (Distance(head, snake.goal) - Distance(next, snake.goal));
+            }
+            if (move.dx == snake.dir.dx && move.dy == snake.dir.dy) {
+                score += 3;
+            }
+        }
+        score += snake.rng.Range(0, 4);
+        if (score > bestScore) {
+            bestScore = score;
+            best = d;
+        }
+    }
+    return best >= 0 ? MOVES[best] : snake.dir;
+}
+
+bool Arena::HeadNear(Position pos, int self) const {
+    for (const Direction& move : MOVES) {
+        Position next = {pos.col + move.dx, pos.row + move.dy};
+        if (InBounds(next)) {
+            int owner = headOwner[next.row * config.width + next.col];
+            if (owner >= 0 && owner != self) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Arena::Spawn(int index) {
+    if (grid.FreeCount() == 0) {
+        return false;
+    }
+    ArenaSnake& snake = snakes[index];
+    Position pos = grid.FreeCell(rng.Range(0, grid.FreeCount() - 1));
+    snake.body.clear();
+    snake.body.push_front(pos);
+    grid.AddSnake(pos);
+    headOwner[pos.row * config.width + pos.col] = index;
+    snake.dir = MOVES[rng.Range(0, 3)];
+    snake.alive = true;
+    snake.growth = config.startLength - 1;
+    snake.score = 0;
+    snake.respawnTimer = 0;
+    snake.goal = {-1, -1};
+    snake.goalAge = 0;
+    aliveCount++;
+    return true;
+}
+
+void Arena::Kill(int index) {
+    ArenaSnake& snake = snakes[index];
+    Position head = snake.body.front();
+    if (headOwner[head.row * config.width + head.col] == index) {
+        headOwner[head.row * config.width + head.col] = -1;
+    }
+    for (int i = 0; i < snake.body.size(); i++) {
+        grid.RemoveSnake(snake.body[i]);
+    }
+    snake.body.clear();
+    snake.alive = false;
+    snake.respawnTimer = config.respawnTicks;
+    aliveCount--;
+}
+
+void Arena::AddApple(Position pos) {
+    grid.SetApple(pos.col, pos.row, (int)apples.size());
+    apples.push_back(pos);
+}
+
+void Arena::RemoveApple(int index) {
+    Position pos = apples[index];
+    grid.ClearApple(pos.col, pos.row);
+    // Swap-remove, fixing the grid's index for the apple that moved
+    if (index != (int)apples.size() - 1) {
+        apples[index] = apples.back();
+        grid.SetApple(apples[index].col, apples[index].row, index);
+    }
+    apples.pop_back();
+}
+
+void Arena::RefillApples() {
+    while ((int)apples.size() < config.apples && grid.FreeCount() > 0) {
+        AddApple(grid.FreeCell(rng.Range(0, grid.FreeCount() - 1)));
+    }
+}
+
+uint64_t Arena::Hash() const {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 0x100000001b3ull;
+        }
+    };
+    mix(tick);
+    mix((uint64_t)aliveCount);
+    for (const ArenaSnake& snake : snakes) {
+        mix(snake.alive);
+        mix((uint64_t)snake.score);
+        mix((uint64_t)snake.growth);
+        mix((uint64_t)snake.body.size());
+        for (int i = 0; i < snake.body.size(); i++) {
+            mix((uint64_t)(uint32_t)snake.body[i].col << 32 | (uint32_t)snake.body[i].row);
+        }
+    }
+    for (const Position& apple : apples) {
+        mix((uint64_t)(uint32_t)apple.col << 32 | (uint32_t)apple.row);
+    }
+    return hash;
+}
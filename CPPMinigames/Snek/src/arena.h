@@ -0,0 +1,111 @@
+#pragma once
+
+#include "game_types.h"
+#include "occupancy_grid.h"
+#include "snake_body.h"
+#include "rng.h"
+#include "worker_pool.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// Settings for an arena session
+struct ArenaConfig {
+    int width = 256;
+    int height = 256;
+    int snakes = 1000;          // Including the player
+    int apples = 0;             // Apples kept on the board; 0 means one per two snakes
+    int startLength = 3;
+    int respawnTicks = 20;      // Bots come back this many moves after dying
+    bool player = true;         // Snake 0 takes QueuePlayerDirection input instead of the bot
+    int threads = 0;            // 0 uses every core
+    uint64_t seed = 1;
+};
+
+struct ArenaSnake {
+    SnakeBody body;
+    Direction dir = {0, 0};
+    bool alive = false;
+    int growth = 0;             // Moves left during which the tail stays put
+    int score = 0;
+    int respawnTimer = 0;
+
+    // Bot state, only touched by this snake's own decision
+    Rng rng;
+    Position goal = {-1, -1};
+    int goalAge = 0;
+};
+
+// Arena mode: hundreds to thousands of snakes (bots plus an optional player)
+// on one shared board with a shared pool of regular apples. Every Step moves
+// every live snake once.
+//
+// Each step has two phases. First the bots decide in parallel. A bot only
+// reads the board as it was at the start of the step and only writes its
+// own ArenaSnake and intent slot, so the thread count can't change the
+// result. Then the moves are resolved serially in snake order:
+// - Heads that leave the board die.
+// - Heads that claim the same cell all die (head-on).
+// - Tails move out of the way.
+// - Heads that land on a body die.
+// - The rest move and eat.
+// The same seed and player inputs always give the same arena.
+class Arena {
+public:
+    void Initialize(const ArenaConfig& config);
+    void Step();
+
+    // Player input, buffered like the single-player direction queue
+    void QueuePlayerDirection(Direction direction);
+    bool HasPlayer() const { return config.player; }
+    bool PlayerAlive() const { return config.player && snakes[0].alive; }
+    const ArenaSnake& Player() const { return snakes[0]; }
+
+    int Width() const { return config.width; }
+    int Height() const { return config.height; }
+    uint32_t Tick() const { return tick; }
+    int AliveCount() const { return aliveCount; }
+    const std::vector<ArenaSnake>& Snakes() const { return snakes; }
+    const std::vector<Position>& Apples() const { return apples; }
+    const OccupancyGrid& Grid() const { return grid; }
+    int Threads() const { return pool ? pool->Size() : 1; }
+
+    // Deaths so far, by cause
+    uint64_t wallDeaths = 0;
+    uint64_t bodyDeaths = 0;
+    uint64_t headOnDeaths = 0;
+
+    // Digest of the whole arena, for checking determinism across thread counts
+    uint64_t Hash() const;
+
+private:
+    Direction DecideBot(int index);
+    // True when a head other than self's is next to pos
+    bool HeadNear(Position pos, int self) const;
+    bool Spawn(int index);
+    void Kill(int index);
+    void AddApple(Position pos);
+    void RemoveApple(int index);
+    void RefillApples();
+    bool InBounds(Position pos) const {
+        return pos.col >= 0 && pos.col < config.width && pos.row >= 0 && pos.row < config.height;
+    }
+
+    ArenaConfig config;
+    std::unique_ptr<WorkerPool> pool;
+    OccupancyGrid grid;
+    std::vector<ArenaSnake> snakes;
+    std::vector<Position> apples;
+    std::deque<Direction> playerQueue;
+    Rng rng;                        // Spawns and apples (serial phase only)
+    uint32_t tick = 0;
+    int aliveCount = 0;
+
+    // Per-step scratch
+    std::vector<Position> intents;
+    std::vector<uint8_t> dying;
+    std::vector<uint32_t> claimStamp;   // Step that last claimed each cell
+    std::vector<int> claimCount;
+    std::vector<int> headOwner;         // Snake whose head is on each cell, or -1
+};
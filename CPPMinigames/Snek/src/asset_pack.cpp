@@ -0,0 +1,169 @@
+#include "asset_pack.h"
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char MAGIC[4] = {'S', 'N', 'K', 'P'};
+    const size_t HEADER_SIZE = 4 + 4 + 4;
+    const size_t ENTRY_SIZE = AssetPack::NAME_SIZE + 4 + 4;
+    const size_t ALIGNMENT = 16;
+
+    uint32_t ReadU32(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    void WriteU32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back((uint8_t)(value >> (8 * i)));
+        }
+    }
+}
+
+bool AssetPack::Open(const std::string& path) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    const void* view = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+    }
+    if (!view) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = (const uint8_t*)view;
+    size = (size_t)fileSize.QuadPart;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    data = (const uint8_t*)view;
+    size = (size_t)info.st_size;
+#endif
+    if (!Parse()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::Close() {
+    if (!data) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap((void*)data, size);
+#endif
+    data = nullptr;
+    size = 0;
+    count = 0;
+}
+
+bool AssetPack::Parse() {
+    if (size < HEADER_SIZE || std::memcmp(data, MAGIC, 4) != 0 || ReadU32(data + 4) != VERSION) {
+        return false;
+    }
+    count = ReadU32(data + 8);
+    if (count > (size - HEADER_SIZE) / ENTRY_SIZE) {
+        return false;
+    }
+    // Check every entry up front so Find can trust the index
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* entry = data + HEADER_SIZE + i * ENTRY_SIZE;
+        uint32_t offset = ReadU32(entry + NAME_SIZE);
+        uint32_t length = ReadU32(entry + NAME_SIZE + 4);
+        if (entry[NAME_SIZE - 1] != 0 || offset > size || length > size - offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const uint8_t* AssetPack::Find(const char* name, size_t& assetSize) const {
+    // A handful of entries, so a linear scan of the index is enough
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* entry = data + HEADER_SIZE + i * ENTRY_SIZE;
+        if (std::strncmp((const char*)entry, name, NAME_SIZE) == 0) {
+            assetSize = ReadU32(entry + NAME_SIZE + 4);
+            return data + ReadU32(entry + NAME_SIZE);
+        }
+    }
+    assetSize = 0;
+    return nullptr;
+}
+
+bool AssetPack::Write(const std::string& path, const std::vector<Entry>& entries) {
+    std::vector<uint8_t> out;
+    for (char c : MAGIC) {
+        out.push_back((uint8_t)c);
+    }
+    WriteU32(out, VERSION);
+    WriteU32(out, (uint32_t)entries.size());
+
+    size_t offset = HEADER_SIZE + entries.size() * ENTRY_SIZE;
+    for (const Entry& entry : entries) {
+        if (entry.name.empty() || entry.name.size() >= NAME_SIZE) {
+            return false;
+        }
+        offset = (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        char name[NAME_SIZE] = {};
+        std::memcpy(name, entry.name.data(), entry.name.size());
+        out.insert(out.end(), name, name + NAME_SIZE);
+        WriteU32(out, (uint32_t)offset);
+        WriteU32(out, (uint32_t)entry.bytes.size());
+        offset += entry.bytes.size();
+    }
+    for (const Entry& entry : entries) {
+        out.resize((out.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, 0);
+        out.insert(out.end(), entry.bytes.begin(), entry.bytes.end());
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write((const char*)out.data(), out.size());
+    return (bool)file;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read-only packed asset archive (snake.pak), built from the sounds/
+// directory by the snake_pack tool at build time and placed next to the
+// executable.
+//
+// Layout (little endian): "SNKP", 32-bit version, 32-bit entry count, then
+// one 48-byte index entry per asset (NUL-padded 40-byte name, 32-bit
+// offset, 32-bit size), then the asset bytes, each starting on a 16-byte
+// boundary. Open maps the whole file with one open and Find returns
+// pointers straight into the mapping, so asset bytes are never copied.
+class AssetPack {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t NAME_SIZE = 40;
+
+    struct Entry {
+        std::string name;
+        std::vector<uint8_t> bytes;
+    };
+
+    AssetPack() = default;
+    ~AssetPack() { Close(); }
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Map a pack file; returns false if it is missing or not a valid pack
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return data != nullptr; }
+
+    // Bytes of the named asset, or nullptr if the pack has no such asset
+    const uint8_t* Find(const char* name, size_t& size) const;
+
+    // Write a pack holding the given assets
+    static bool Write(const std::string& path, const std::vector<Entry>& entries);
+
+private:
+    bool Parse();
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    uint32_t count = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
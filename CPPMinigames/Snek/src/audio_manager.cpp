@@ -0,0 +1,185 @@
+#include "audio_manager.h"
+#include "raylib.h"
+#include <string>
+
+namespace {
+    const char* const SOUND_FILES[SOUND_COUNT] = {
+        "apple.mp3",        // SOUND_APPLE
+        "poison.mp3",       // SOUND_POISON
+        "golden.mp3",       // SOUND_GOLDEN
+        "purple.mp3",       // SOUND_PURPLE
+        "gameover.mp3",     // SOUND_GAME_OVER
+        "pause.mp3",        // SOUND_PAUSE
+    };
+    
+    // The sound an event makes, if any
+    bool SoundFor(const GameEvent& event, SoundEffect& sound) {
+        switch (event.type) {
+            case EVENT_ATE_APPLE:
+                if (event.food == POMME_PLUS || event.food == POMME_SUPREME) {
+                    sound = SOUND_GOLDEN;
+                    return true;
+                }
+                if (event.food == REGULAR && !event.blocked) {
+                    sound = SOUND_APPLE;
+                    return true;
+                }
+                return false;
+            case EVENT_TELEPORTED:
+                sound = SOUND_PURPLE;
+                return true;
+            case EVENT_DIED:
+                sound = SOUND_GAME_OVER;
+                return true;
+            case EVENT_REMINDER:
+                sound = (event.timer == TIMER_POISON_SOUND) ? SOUND_POISON : SOUND_PAUSE;
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    double MillisSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+AudioManager::~AudioManager() {
+    if (loader.joinable()) {
+        loader.join();
+    }
+}
+
+void AudioManager::StartLoading() {
+    loadStart = std::chrono::steady_clock::now();
+    
+    #ifdef PLATFORM_WEB
+    // On web, the pack is preloaded at the root of the virtual file system
+    packPath = "/snake.pak";
+    #else
+    // The build puts the pack next to the executable
+    packPath = std::string(GetApplicationDirectory()) + "snake.pak";
+    
+    // Opening the pack touches the disk, so it happens on the loader too.
+    // Decoding only reads memory, so it is safe off the main thread.
+    loader = std::thread([this]() {
+        OpenPack();
+        for (int i = 0; i < SOUND_COUNT; i++) {
+            Decode(i);
+        }
+    });
+    #endif
+}
+
+void AudioManager::OpenPack() {
+    if (!pack.Open(packPath)) {
+        TraceLog(LOG_WARNING, "AUDIO: Could not open asset pack %s, playing without sound", packPath.c_str());
+    }
+}
+
+void AudioManager::Decode(int index) {
+    // The wave is decoded straight from the mapped pack
+    size_t size = 0;
+    const uint8_t* bytes = pack.IsOpen() ? pack.Find(SOUND_FILES[index], size) : nullptr;
+    if (bytes) {
+        waves[index] = LoadWaveFromMemory(".mp3", bytes, (int)size);
+    } else if (pack.IsOpen()) {
+        TraceLog(LOG_WARNING, "AUDIO: %s is missing from %s", SOUND_FILES[index], packPath.c_str());
+    }
+    waveReady[index].store(true, std::memory_order_release);
+}
+
+void AudioManager::Update() {
+    if (Ready()) {
+        return;
+    }
+    
+    // Opening the device can take a while too, so the first call (made after
+    // the first frame is presented) only does that
+    if (!deviceOpen) {
+        InitAudioDevice();
+        deviceOpen = true;
+        return;
+    }
+    
+    #ifdef PLATFORM_WEB
+    // No loader thread on web: decode one sound per frame instead
+    if (!pack.IsOpen() && !waveReady[0].load(std::memory_order_relaxed)) {
+        OpenPack();
+    }
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        if (!waveReady[i].load(std::memory_order_relaxed)) {
+            Decode(i);
+            break;
+        }
+    }
+    #endif
+    
+    // Upload whatever the loader has finished
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        if (!soundReady[i] && waveReady[i].load(std::memory_order_acquire)) {
+            if (waves[i].data != nullptr) {
+                sounds[i] = LoadSoundFromWave(waves[i]);
+                UnloadWave(waves[i]);
+                waves[i] = {};
+            }
+            soundReady[i] = true;
+            readyCount++;
+        }
+    }
+    if (Ready()) {
+        // Everything is uploaded, so the loader is done and the pack can go
+        if (loader.joinable()) {
+            loader.join();
+        }
+        pack.Close();
+        TraceLog(LOG_INFO, "AUDIO: %d sounds ready %.1f ms after loading started", SOUND_COUNT, MillisSince(loadStart));
+    }
+}
+
+void AudioManager::Unload() {
+    if (loader.joinable()) {
+        loader.join();
+    }
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        if (soundReady[i] && sounds[i].frameCount > 0) {
+            UnloadSound(sounds[i]);
+        }
+        // Decoded but never uploaded (an upload frees the wave and clears it)
+        if (waveReady[i].load(std::memory_order_acquire) && waves[i].data != nullptr) {
+            UnloadWave(waves[i]);
+        }
+        soundReady[i] = false;
+        waveReady[i] = false;
+        sounds[i] = {};
+        waves[i] = {};
+    }
+    readyCount = 0;
+    pack.Close();
+    if (deviceOpen) {
+        CloseAudioDevice();
+        deviceOpen = false;
+    }
+}
+
+void AudioManager::Play(SoundEffect sound) {
+    // Effects asked for while their sound is still loading are dropped
+    if (soundReady[sound]) {
+        PlaySound(sounds[sound]);
+    }
+}
+
+void AudioManager::PlayEvents(const GameEventQueue& events) {
+    unsigned int pendingSounds = 0;
+    for (const GameEvent& event : events) {
+        SoundEffect sound;
+        if (SoundFor(event, sound)) {
+            pendingSounds |= 1u << sound;
+        }
+    }
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        if (pendingSounds & (1u << i)) {
+            Play((SoundEffect)i);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "game_types.h"
+#include "game_events.h"
+#include "asset_pack.h"
+#include "raylib.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// Owns the audio device and the raylib sounds, and plays the effects for
+// the simulation's events. Loading never blocks a frame: the sounds are decoded
+// from the asset pack on a background thread, and Update (called once per frame) opens
+// the audio device after the first frame and uploads each sound as soon as
+// it is decoded. Sounds requested before they are ready are skipped.
+class AudioManager {
+public:
+    ~AudioManager();
+
+    // Starts decoding the sound files and returns at once
+    void StartLoading();
+    // Main thread, once per frame after EndDrawing
+    void Update();
+    bool Ready() const { return readyCount == SOUND_COUNT; }
+    void Unload();
+
+    void Play(SoundEffect sound);
+    // Subscriber for GameState::events; each sound plays at most once per call
+    void PlayEvents(const GameEventQueue& events);
+
+private:
+    void OpenPack();
+    void Decode(int index);
+
+    std::string packPath;
+    AssetPack pack;
+    std::thread loader;
+    std::chrono::steady_clock::time_point loadStart;
+
+    // Written by the loader; waves[i] may be read once waveReady[i] is set
+    Wave waves[SOUND_COUNT] = {};
+    std::atomic<bool> waveReady[SOUND_COUNT] = {};
+
+    // Main thread only
+    Sound sounds[SOUND_COUNT] = {};
+    bool soundReady[SOUND_COUNT] = {};
+    int readyCount = 0;
+    bool deviceOpen = false;
+};
@@ -0,0 +1,346 @@
+#include "autopilot.h"
+#include "game_logic.h"
+#include <algorithm>
+
+namespace {
+    // Same order as the replay log: up, down, left, right
+    const Direction MOVES[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+    const uint8_t NO_MOVE = 0xff;
+
+    // Reading the clock costs more than expanding a node, so only check it this often
+    const int CLOCK_CHECK_INTERVAL = 64;
+
+    int MoveInterval(const GameState& state) {
+        return (state.gameMode == MODE_ACCELERATED)
+            ? GameConstants::MOVE_INTERVAL_ACCELERATED
+            : GameConstants::MOVE_INTERVAL_REGULAR;
+    }
+}
+
+bool Autopilot::ChooseMove(const GameState& state, Direction& move) {
+    if (state.showModeSelection || state.showInstructions || state.snake.empty() ||
+        !state.directionQueue.empty() || !GameLogic::MovesNextStep(state)) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    budgetStart = start;
+    nodesUsed = 0;
+    overBudget = false;
+    move = Decide(state);
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    stats.decisions++;
+    if (overBudget) {
+        stats.overBudget++;
+    }
+    stats.lastMicros = micros;
+    stats.totalMicros += micros;
+    stats.maxMicros = std::max(stats.maxMicros, micros);
+    return true;
+}
+
+Direction Autopilot::Decide(const GameState& state) {
+    const int width = state.boardWidth;
+    const int cells = width * state.boardHeight;
+    if ((int)visitStamp.size() != cells) {
+        visitStamp.assign(cells, 0);
+        firstMove.assign(cells, NO_MOVE);
+        distance.assign(cells, 0);
+        stamp = 0;
+    }
+
+    Position head = state.snake.front();
+    bool moving = state.dx != 0 || state.dy != 0;
+
+    // Effects run out before the snake moves on that tick, so one ending on
+    // the tick of this move no longer protects it
+    passSelf = state.canIntersectSelf && state.TicksLeft(TIMER_IMMUNITY) > 1;
+    passWalls = state.canPassWalls && state.TicksLeft(TIMER_WALL_IMMUNITY) > 1;
+
+    // In regular mode a lone poison apple is never replaced until eaten, so
+    // when it's all that's left (and we aren't poisoned already) go for it
+    eatPoison = false;
+    bool hungry = !state.cannotEatApples;
+    for (const Apple& apple : state.apples) {
+        if (AppleValue(state, apple, 0) > 0) {
+            hungry = false;
+            break;
+        }
+    }
+    eatPoison = hungry;
+
+    // Phase 1, half the budget: BFS from the head to find the apple worth the
+    // most per step. firstMove remembers which opening move reaches each cell.
+    StartPhase(0.5);
+    NextStamp();
+    visitStamp[head.row * width + head.col] = stamp;
+    queue.clear();
+    for (int dir = 0; dir < 4; dir++) {
+        Position next;
+        if (!FirstStep(state, dir, false, next)) {
+            continue;
+        }
+        int index = next.row * width + next.col;
+        if (visitStamp[index] != stamp) {
+            visitStamp[index] = stamp;
+            firstMove[index] = (uint8_t)dir;
+            distance[index] = 1;
+            queue.push_back(index);
+        }
+    }
+
+    int target = -1;
+    int targetValue = 0;
+    int targetDistance = 0;
+    int nearestDistance = -1;
+    for (size_t next = 0; next < queue.size() && !OutOfBudget(); next++) {
+        int index = queue[next];
+        int d = distance[index];
+
+        // A farther apple can't beat the nearest one by more than 2:1 in value
+        if (nearestDistance >= 0 && d > 2 * nearestDistance) {
+            break;
+        }
+
+        Position pos = {index % width, index / width};
+        int appleIndex = state.grid.AppleAt(pos.col, pos.row);
+        if (appleIndex != OccupancyGrid::NO_APPLE) {
+            int value = AppleValue(state, state.apples[appleIndex], d);
+            if (value > 0) {
+                if (target < 0 || value * targetDistance > targetValue * d) {
+                    target = index;
+                    targetValue = value;
+                    targetDistance = d;
+                }
+                if (nearestDistance < 0) {
+                    nearestDistance = d;
+                }
+            }
+        }
+
+        for (int dir = 0; dir < 4; dir++) {
+            Position neighbor;
+            if (!Neighbor(state, pos, dir, neighbor) || !Passable(state, neighbor, false)) {
+                continue;
+            }
+            int neighborIndex = neighbor.row * width + neighbor.col;
+            if (visitStamp[neighborIndex] != stamp) {
+                visitStamp[neighborIndex] = stamp;
+                firstMove[neighborIndex] = firstMove[index];
+                distance[neighborIndex] = d + 1;
+                queue.push_back(neighborIndex);
+            }
+        }
+    }
+    int preferred = (target >= 0) ? firstMove[target] : -1;
+
+    // Nothing found within the budget (e.g. on a giant board): head straight
+    // for the apple that looks best by distance alone
+    if (target < 0) {
+        preferred = GreedyMove(state, head);
+    }
+
+    // Phase 2, the rest of the budget: a move is safe if the space it opens
+    // onto can still hold the whole body. Try the path to the apple first,
+    // otherwise take whichever move leads to the most room.
+    StartPhase(1.0);
+    const int needed = state.snake.size();
+    int bestDir = -1;
+    int bestSpace = -1;
+    for (int attempt = -1; attempt < 4; attempt++) {
+        int dir = (attempt < 0) ? preferred : attempt;
+        if (dir < 0 || (attempt >= 0 && dir == preferred)) {
+            continue;
+        }
+        Position next;
+        if (!FirstStep(state, dir, false, next)) {
+            continue;
+        }
+        int space = FloodFill(state, next, needed);
+        if (space >= needed && dir == preferred) {
+            return MOVES[dir];
+        }
+        if (space > bestSpace) {
+            bestDir = dir;
+            bestSpace = space;
+        }
+    }
+    if (bestDir >= 0) {
+        return MOVES[bestDir];
+    }
+
+    // Every move leads somewhere bad: still prefer one that survives this
+    // step (onto poison, say) to one that ends the game now
+    for (int dir = 0; dir < 4; dir++) {
+        Position next;
+        if (!FirstStep(state, dir, true, next)) {
+            continue;
+        }
+        return MOVES[dir];
+    }
+    return moving ? Direction{state.dx, state.dy} : MOVES[0];
+}
+
+bool Autopilot::Neighbor(const GameState& state, Position pos, int dir, Position& next) const {
+    next = {pos.col + MOVES[dir].dx, pos.row + MOVES[dir].dy};
+    if (next.col >= 0 && next.col < state.boardWidth && next.row >= 0 && next.row < state.boardHeight) {
+        return true;
+    }
+    if (!passWalls) {
+        return false;
+    }
+    next.col = (next.col + state.boardWidth) % state.boardWidth;
+    next.row = (next.row + state.boardHeight) % state.boardHeight;
+    return true;
+}
+
+bool Autopilot::FirstStep(const GameState& state, int dir, bool survive, Position& next) const {
+    bool moving = state.dx != 0 || state.dy != 0;
+    if (moving && MOVES[dir].dx == -state.dx && MOVES[dir].dy == -state.dy) {
+        return false;
+    }
+    if (!Neighbor(state, state.snake.front(), dir, next)) {
+        return false;
+    }
+    return survive ? !HitsBody(state, next, true) : Passable(state, next, true);
+}
+
+bool Autopilot::HitsBody(const GameState& state, Position pos, bool fromHead) const {
+    if (passSelf || !state.grid.HasSnake(pos.col, pos.row)) {
+        return false;
+    }
+    // The collision check runs before the tail moves, so the head can't step
+    // onto the tail. Later in a path the tail has moved on and its cell is free.
+    const Position& tail = state.snake.back();
+    return fromHead || tail.col != pos.col || tail.row != pos.row;
+}
+
+bool Autopilot::Passable(const GameState& state, Position pos, bool fromHead) const {
+    if (HitsBody(state, pos, fromHead)) {
+        return false;
+    }
+
+    // Poison reverses the snake into its own body, so keep clear of it unless it's the only food
+    int appleIndex = state.grid.AppleAt(pos.col, pos.row);
+    return appleIndex == OccupancyGrid::NO_APPLE || state.apples[appleIndex].type != POISONOUS || eatPoison;
+}
+
+int Autopilot::AppleValue(const GameState& state, const Apple& apple, int distance) const {
+    // Skip apples that will despawn before we get there
+    if (state.gameMode == MODE_ACCELERATED) {
+        uint32_t age = state.gameTicks - apple.spawnTick;
+        uint32_t remaining = (age < apple.lifetime) ? apple.lifetime - age : 0;
+        if ((int64_t)distance * MoveInterval(state) > (int64_t)remaining) {
+            return 0;
+        }
+    }
+
+    // Golden apples work even while poisoned. A teleport lands somewhere
+    // random, so it's only worth it when nothing better is around.
+    switch (apple.type) {
+        case POMME_PLUS:
+        case POMME_SUPREME:
+            return 4;
+        case REGULAR:
+            return state.cannotEatApples ? 0 : 2;
+        case TELEPORT:
+            return state.cannotEatApples ? 0 : 1;
+        case POISONOUS:
+            return eatPoison ? 1 : 0;
+    }
+    return 0;
+}
+
+int Autopilot::GreedyMove(const GameState& state, Position head) const {
+    // Pick the apple with the best value per (wrap-aware) Manhattan distance
+    const Apple* best = nullptr;
+    int bestValue = 0;
+    int bestDistance = 0;
+    for (const Apple& apple : state.apples) {
+        int d = Distance(head.col, apple.col, state.boardWidth) +
+                Distance(head.row, apple.row, state.boardHeight);
+        int value = AppleValue(state, apple, d);
+        if (value > 0 && (!best || value * bestDistance > bestValue * d)) {
+            best = &apple;
+            bestValue = value;
+            bestDistance = d;
+        }
+    }
+    if (!best) {
+        return -1;
+    }
+
+    // First legal move that gets closer
+    for (int dir = 0; dir < 4; dir++) {
+        Position next;
+        if (!FirstStep(state, dir, false, next)) {
+            continue;
+        }
+        int d = Distance(next.col, best->col, state.boardWidth) +
+                Distance(next.row, best->row, state.boardHeight);
+        if (d < bestDistance) {
+            return dir;
+        }
+    }
+    return -1;
+}
+
+int Autopilot::Distance(int from, int to, int size) const {
+    int d = (from > to) ? from - to : to - from;
+    return passWalls ? std::min(d, size - d) : d;
+}
+
+int Autopilot::FloodFill(const GameState& state, Position start, int limit) {
+    const int width = state.boardWidth;
+    NextStamp();
+    queue.clear();
+    visitStamp[start.row * width + start.col] = stamp;
+    queue.push_back(start.row * width + start.col);
+
+    for (size_t next = 0; next < queue.size() && (int)queue.size() < limit; next++) {
+        // Out of time: assume the space is big enough rather than turning blindly
+        if (OutOfBudget()) {
+            return limit;
+        }
+        Position pos = {queue[next] % width, queue[next] / width};
+        for (int dir = 0; dir < 4; dir++) {
+            Position neighbor;
+            if (!Neighbor(state, pos, dir, neighbor) || !Passable(state, neighbor, false)) {
+                continue;
+            }
+            int neighborIndex = neighbor.row * width + neighbor.col;
+            if (visitStamp[neighborIndex] != stamp) {
+                visitStamp[neighborIndex] = stamp;
+                queue.push_back(neighborIndex);
+            }
+        }
+    }
+    return (int)queue.size();
+}
+
+void Autopilot::NextStamp() {
+    if (++stamp == 0) {
+        std::fill(visitStamp.begin(), visitStamp.end(), 0);
+        stamp = 1;
+    }
+}
+
+void Autopilot::StartPhase(double budgetFraction) {
+    deadline = budgetStart + std::chrono::microseconds((int64_t)(budgetMicros * budgetFraction));
+    nodeLimit = (maxNodes > 0) ? (int64_t)(maxNodes * budgetFraction) : INT64_MAX;
+    phaseOver = false;
+}
+
+bool Autopilot::OutOfBudget() {
+    if (phaseOver) {
+        return true;
+    }
+    nodesUsed++;
+    if (nodesUsed > nodeLimit ||
+        (budgetMicros > 0 && nodesUsed % CLOCK_CHECK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline)) {
+        phaseOver = true;
+        overBudget = true;
+    }
+    return phaseOver;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "controller.h"
+#include "game_state.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Pathfinding bot that plays by queueing directions, exactly like keyboard
+// input, so its games record and replay like any other. Each decision runs
+// a BFS from the head to the most valuable reachable apple (skipping poison,
+// and anything but golden apples while poisoned), then flood-fills from the
+// chosen next cell to make sure the body still fits in the space it leads
+// to. Wrap-around is followed while canPassWalls is active.
+//
+// Every decision stops searching once its time budget is spent and goes with
+// the best move found so far. A node budget can be used instead (budget 0
+// turns the clock off) when runs must be reproducible across machines.
+// Search buffers are kept between decisions, so steady-state play does not
+// allocate.
+class Autopilot : public Controller {
+public:
+    explicit Autopilot(int budgetMicros = 500, int maxNodes = 0)
+        : budgetMicros(budgetMicros), maxNodes(maxNodes) {}
+
+    void SetBudget(int micros) { budgetMicros = micros; }
+    void SetMaxNodes(int nodes) { maxNodes = nodes; }
+
+    // Call once before each GameLogic::Step. Returns true with the direction
+    // to queue when the snake is about to move and nothing is queued yet.
+    bool ChooseMove(const GameState& state, Direction& move) override;
+
+    // Timing of the decisions made so far
+    struct Stats {
+        uint64_t decisions = 0;
+        uint64_t overBudget = 0;        // Decisions cut short by the budget
+        double lastMicros = 0.0;
+        double maxMicros = 0.0;
+        double totalMicros = 0.0;
+    };
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    Direction Decide(const GameState& state);
+
+    // Cell reached by one step from pos, or false for a wall
+    bool Neighbor(const GameState& state, Position pos, int dir, Position& next) const;
+    // Whether the snake can enter pos: fromHead for the cell the head moves
+    // into next, false for cells further along a path
+    bool Passable(const GameState& state, Position pos, bool fromHead) const;
+    bool HitsBody(const GameState& state, Position pos, bool fromHead) const;
+    // Cell the head enters moving in dir, if that move is allowed: not a
+    // reversal or into a wall, and Passable (with survive, only not fatal)
+    bool FirstStep(const GameState& state, int dir, bool survive, Position& next) const;
+    int AppleValue(const GameState& state, const Apple& apple, int distance) const;
+    // Fallback when the search finds nothing: step toward the best apple by straight-line distance
+    int GreedyMove(const GameState& state, Position head) const;
+    int Distance(int from, int to, int size) const;
+
+    // Free cells reachable from start, counting up to limit
+    int FloodFill(const GameState& state, Position start, int limit);
+
+    void NextStamp();
+    // Searching stops once this fraction of the decision's budget is used
+    void StartPhase(double budgetFraction);
+    bool OutOfBudget();
+
+    int budgetMicros;
+    int maxNodes;
+    Stats stats;
+
+    // Search scratch, reused between decisions. A cell counts as visited when
+    // its stamp equals the current search's stamp, so nothing is cleared.
+    std::vector<uint32_t> visitStamp;
+    std::vector<uint8_t> firstMove;
+    std::vector<int> distance;
+    std::vector<int> queue;
+    uint32_t stamp = 0;
+    bool eatPoison = false;
+    bool passSelf = false;      // Immunities that still hold for the coming move
+    bool passWalls = false;
+
+    std::chrono::steady_clock::time_point budgetStart;
+    std::chrono::steady_clock::time_point deadline;
+    int64_t nodesUsed = 0;
+    int64_t nodeLimit = 0;
+    bool phaseOver = false;
+    bool overBudget = false;
+};
@@ -0,0 +1,516 @@
+#include "batch_engine.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const Direction ACTIONS[BatchEngine::ACTION_COUNT] = {{0, 0}, {0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+    const int INITIAL_RING_SIZE = 256;
+
+    inline void Prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+}
+
+void BatchEngine::Initialize(const Config& newConfig) {
+    config = newConfig;
+    games = std::max(config.games, 0);
+    width = std::clamp(config.boardWidth, GameConstants::MIN_BOARD_SIZE, GameConstants::MAX_BOARD_SIZE);
+    height = std::clamp(config.boardHeight, GameConstants::MIN_BOARD_SIZE, GameConstants::MAX_BOARD_SIZE);
+    cells = width * height;
+    moveInterval = (config.mode == MODE_ACCELERATED)
+        ? GameConstants::MOVE_INTERVAL_ACCELERATED
+        : GameConstants::MOVE_INTERVAL_REGULAR;
+
+    headCol.assign(games, 0);
+    headRow.assign(games, 0);
+    dx.assign(games, 0);
+    dy.assign(games, 0);
+    length.assign(games, 0);
+    score.assign(games, 0);
+    movesSinceTeleport.assign(games, -1);
+    tick.assign(games, 0);
+    nextMove.assign(games, 0);
+    nextEvent.assign(games, NEVER);
+    immunityEnd.assign(games, 0);
+    wallImmunityEnd.assign(games, 0);
+    cannotEatEnd.assign(games, 0);
+    over.assign(games, 0);
+    deathCause.assign(games, DEATH_NONE);
+    rngs.assign(games, Rng());
+
+    ringSize = 1;
+    while (ringSize < std::min(cells, INITIAL_RING_SIZE)) {
+        ringSize <<= 1;
+    }
+    ring.assign((size_t)games * ringSize, 0);
+    ringHead.assign(games, 0);
+    ringReversed.assign(games, 0);
+
+    appleCount.assign(games, 0);
+    appleCell.assign((size_t)games * GameConstants::MAX_APPLES, 0);
+    appleType.assign((size_t)games * GameConstants::MAX_APPLES, REGULAR);
+    appleSpawn.assign((size_t)games * GameConstants::MAX_APPLES, 0);
+    appleLifetime.assign((size_t)games * GameConstants::MAX_APPLES, 0);
+
+    board.assign((size_t)games * cells, BoardCell());
+    freeWords = FreeCells::Words(cells);
+    freeBits.assign((size_t)games * freeWords, 0);
+    freeCounts.assign((size_t)games * freeWords, 0);
+    freeCount.assign(games, 0);
+    emptyBoard.assign(cells, {0, -1});
+    emptyBits.resize(freeWords);
+    emptyCounts.resize(freeWords);
+    FreeCells::Fill(emptyBits.data(), emptyCounts.data(), cells);
+
+    target.assign(games, 0);
+    outcome.assign(games, OUTCOME_NONE);
+    slow.reserve(games);
+
+    for (int game = 0; game < games; game++) {
+        Reset(game, 0);
+    }
+}
+
+void BatchEngine::Reset(int game, uint64_t seed) {
+    rngs[game].Seed(seed);
+
+    // Empty board, every cell free (OccupancyGrid::Clear)
+    std::memcpy(&board[(size_t)game * cells], emptyBoard.data(), cells * sizeof(BoardCell));
+    std::memcpy(&freeBits[(size_t)game * freeWords], emptyBits.data(), freeWords * sizeof(uint64_t));
+    std::memcpy(&freeCounts[(size_t)game * freeWords], emptyCounts.data(), freeWords * sizeof(uint32_t));
+    freeCount[game] = cells;
+    length[game] = 0;
+    ringHead[game] = 0;
+    ringReversed[game] = 0;
+    appleCount[game] = 0;
+
+    int col = rngs[game].Range(0, width - 1);
+    int row = rngs[game].Range(0, height - 1);
+    PushHead(game, row * width + col);
+    headCol[game] = (int16_t)col;
+    headRow[game] = (int16_t)row;
+
+    int initialApples = (config.mode == MODE_ACCELERATED) ? 3 : 1;
+    for (int i = 0; i < initialApples; i++) {
+        SpawnApple(game, 0);
+    }
+
+    dx[game] = 0;
+    dy[game] = 0;
+    score[game] = 0;
+    movesSinceTeleport[game] = -1;
+    tick[game] = 0;
+    nextMove[game] = moveInterval;
+    immunityEnd[game] = 0;
+    wallImmunityEnd[game] = 0;
+    cannotEatEnd[game] = 0;
+    over[game] = 0;
+    deathCause[game] = DEATH_NONE;
+    UpdateNextEvent(game, 0);
+}
+
+void BatchEngine::Step(const uint8_t* actions) {
+    // Turn, jump the clock to the move (the ticks between change nothing but
+    // due despawns and refills, which are caught up on below) and find where
+    // the head goes. The cells the move will touch are prefetched, since
+    // thousands of boards don't fit in cache.
+    for (int game = 0; game < games; game++) {
+        if (over[game]) {
+            outcome[game] = OUTCOME_NONE;
+            continue;
+        }
+        int action = (actions[game] < ACTION_COUNT) ? actions[game] : 0;
+        int turnX = ACTIONS[action].dx;
+        int turnY = ACTIONS[action].dy;
+        bool still = dx[game] == 0 && dy[game] == 0;
+        bool reversal = turnX == -dx[game] && turnY == -dy[game];
+        if (action != 0 && (still || !reversal)) {
+            dx[game] = (int8_t)turnX;
+            dy[game] = (int8_t)turnY;
+        }
+        tick[game] = nextMove[game];
+
+        if (dx[game] == 0 && dy[game] == 0) {
+            outcome[game] = OUTCOME_STILL;
+            continue;
+        }
+        if (movesSinceTeleport[game] >= 0) {
+            movesSinceTeleport[game]++;
+        }
+        int col = headCol[game] + dx[game];
+        int row = headRow[game] + dy[game];
+        if (tick[game] < wallImmunityEnd[game]) {
+            col = (col < 0) ? width - 1 : (col >= width ? 0 : col);
+            row = (row < 0) ? height - 1 : (row >= height ? 0 : row);
+        } else if (col < 0 || col >= width || row < 0 || row >= height) {
+            outcome[game] = OUTCOME_WALL;
+            continue;
+        }
+        // Every outcome from here on moves the head to the target
+        target[game] = row * width + col;
+        headCol[game] = (int16_t)col;
+        headRow[game] = (int16_t)row;
+        outcome[game] = OUTCOME_MOVE;
+        Prefetch(&board[(size_t)game * cells + target[game]]);
+        Prefetch(&RingAt(game, length[game] - 1));
+    }
+
+    // Apple despawns and refills due up to the move
+    for (int game = 0; game < games; game++) {
+        if (!over[game] && nextEvent[game] <= tick[game]) {
+            RunEvents(game);
+        }
+    }
+
+    // What the head hits
+    for (int game = 0; game < games; game++) {
+        if (outcome[game] != OUTCOME_MOVE) {
+            continue;
+        }
+        const BoardCell& at = board[(size_t)game * cells + target[game]];
+        if (tick[game] >= immunityEnd[game] && at.snake != 0) {
+            outcome[game] = OUTCOME_SELF;
+        } else if (at.apple >= 0) {
+            outcome[game] = OUTCOME_EAT;
+        } else {
+            int32_t tail = RingAt(game, length[game] - 1);
+            Prefetch(&board[(size_t)game * cells + tail]);
+            Prefetch(&freeBits[(size_t)game * freeWords + target[game] / 64]);
+            Prefetch(&freeBits[(size_t)game * freeWords + tail / 64]);
+        }
+    }
+
+    // Plain moves; everything else goes to the slow path
+    slow.clear();
+    for (int game = 0; game < games; game++) {
+        switch (outcome[game]) {
+            case OUTCOME_NONE:
+                break;
+            case OUTCOME_STILL:
+                nextMove[game] += moveInterval;
+                break;
+            case OUTCOME_MOVE:
+                PushHead(game, target[game]);
+                PopTail(game);
+                nextMove[game] += moveInterval;
+                // A refill that failed for want of room can happen now
+                if (config.mode == MODE_ACCELERATED && appleCount[game] < GameConstants::MIN_APPLES &&
+                    freeCount[game] > 0) {
+                    nextEvent[game] = std::min(nextEvent[game], tick[game] + 1);
+                }
+                break;
+            default:
+                slow.push_back(game);
+                break;
+        }
+    }
+
+    for (int game : slow) {
+        switch (outcome[game]) {
+            case OUTCOME_WALL:
+                EndGame(game, DEATH_WALL);
+                break;
+            case OUTCOME_SELF:
+                PushHead(game, target[game]);
+                EndGame(game, DEATH_SELF);
+                break;
+            case OUTCOME_EAT: {
+                int apple = board[(size_t)game * cells + target[game]].apple;
+                PushHead(game, target[game]);
+                nextMove[game] += moveInterval;
+                Consume(game, apple);
+                UpdateHead(game);
+                UpdateNextEvent(game, tick[game]);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+Position BatchEngine::Segment(int game, int i) const {
+    unsigned mask = ringSize - 1;
+    unsigned physical = (ringReversed[game] ? ringHead[game] - (unsigned)i : ringHead[game] + (unsigned)i) & mask;
+    int32_t cell = ring[(size_t)game * ringSize + physical];
+    return {cell % width, cell / width};
+}
+
+Apple BatchEngine::GetApple(int game, int i) const {
+    size_t slot = (size_t)game * GameConstants::MAX_APPLES + i;
+    Apple apple;
+    apple.col = appleCell[slot] % width;
+    apple.row = appleCell[slot] / width;
+    apple.type = (FoodType)appleType[slot];
+    apple.spawnTick = appleSpawn[slot];
+    apple.lifetime = appleLifetime[slot];
+    return apple;
+}
+
+int32_t& BatchEngine::RingAt(int game, int i) {
+    unsigned mask = ringSize - 1;
+    unsigned physical = (ringReversed[game] ? ringHead[game] - (unsigned)i : ringHead[game] + (unsigned)i) & mask;
+    return ring[(size_t)game * ringSize + physical];
+}
+
+void BatchEngine::PushHead(int game, int32_t cell) {
+    if (length[game] == ringSize) {
+        GrowRings();
+    }
+    ringHead[game] = (ringReversed[game] ? ringHead[game] + 1 : ringHead[game] - 1) & (ringSize - 1);
+    ring[(size_t)game * ringSize + ringHead[game]] = cell;
+    length[game]++;
+    AddSnake(game, cell);
+}
+
+void BatchEngine::PopHead(int game) {
+    RemoveSnake(game, RingAt(game, 0));
+    ringHead[game] = (ringReversed[game] ? ringHead[game] - 1 : ringHead[game] + 1) & (ringSize - 1);
+    length[game]--;
+}
+
+void BatchEngine::PushTail(int game, int32_t cell) {
+    if (length[game] == ringSize) {
+        GrowRings();
+    }
+    RingAt(game, length[game]) = cell;
+    length[game]++;
+    AddSnake(game, cell);
+}
+
+void BatchEngine::PopTail(int game) {
+    RemoveSnake(game, RingAt(game, length[game] - 1));
+    length[game]--;
+}
+
+void BatchEngine::ReverseSnake(int game) {
+    if (length[game] > 0) {
+        ringHead[game] = (ringReversed[game] ? ringHead[game] - (length[game] - 1) : ringHead[game] + (length[game] - 1)) &
+                         (ringSize - 1);
+        ringReversed[game] = !ringReversed[game];
+    }
+}
+
+void BatchEngine::GrowRings() {
+    // Rare (a snake overlapping itself past the ring); every game is laid out head first again
+    int newSize = ringSize * 2;
+    std::vector<int32_t> grown((size_t)games * newSize);
+    for (int game = 0; game < games; game++) {
+        for (int i = 0; i < length[game]; i++) {
+            grown[(size_t)game * newSize + i] = RingAt(game, i);
+        }
+        ringHead[game] = 0;
+        ringReversed[game] = 0;
+    }
+    ring.swap(grown);
+    ringSize = newSize;
+}
+
+void BatchEngine::UpdateHead(int game) {
+    if (length[game] > 0) {
+        int32_t cell = RingAt(game, 0);
+        headCol[game] = (int16_t)(cell % width);
+        headRow[game] = (int16_t)(cell / width);
+    }
+}
+
+void BatchEngine::AddSnake(int game, int32_t cell) {
+    if (board[(size_t)game * cells + cell].snake++ == 0) {
+        MarkTaken(game, cell);
+    }
+}
+
+void BatchEngine::RemoveSnake(int game, int32_t cell) {
+    BoardCell& at = board[(size_t)game * cells + cell];
+    if (--at.snake == 0 && at.apple < 0) {
+        MarkFree(game, cell);
+    }
+}
+
+void BatchEngine::MarkFree(int game, int32_t cell) {
+    size_t base = (size_t)game * freeWords;
+    if (FreeCells::Add(&freeBits[base], &freeCounts[base], freeWords, cell)) {
+        freeCount[game]++;
+    }
+}
+
+void BatchEngine::MarkTaken(int game, int32_t cell) {
+    size_t base = (size_t)game * freeWords;
+    if (FreeCells::Remove(&freeBits[base], &freeCounts[base], freeWords, cell)) {
+        freeCount[game]--;
+    }
+}
+
+int32_t BatchEngine::FreeCell(int game, int index) const {
+    size_t base = (size_t)game * freeWords;
+    return FreeCells::Find(&freeBits[base], &freeCounts[base], freeWords, index);
+}
+
+bool BatchEngine::SpawnApple(int game, uint32_t now) {
+    if (appleCount[game] >= GameConstants::MAX_APPLES || freeCount[game] == 0) {
+        return false;
+    }
+    Rng& rng = rngs[game];
+    int32_t cell = FreeCell(game, rng.Range(0, freeCount[game] - 1));
+    FoodType type = config.rules.RollFood(rng);
+    uint32_t lifetime = rng.Range(config.rules.despawnTimeMin, config.rules.despawnTimeMax) * GameConstants::TICK_RATE;
+
+    int index = appleCount[game]++;
+    size_t slot = (size_t)game * GameConstants::MAX_APPLES + index;
+    appleCell[slot] = cell;
+    appleType[slot] = (uint8_t)type;
+    appleSpawn[slot] = now;
+    appleLifetime[slot] = lifetime;
+    board[(size_t)game * cells + cell].apple = (int8_t)index;
+    MarkTaken(game, cell);
+    return true;
+}
+
+void BatchEngine::RemoveApple(int game, int index) {
+    size_t base = (size_t)game * GameConstants::MAX_APPLES;
+    size_t boardBase = (size_t)game * cells;
+    int32_t cell = appleCell[base + index];
+    board[boardBase + cell].apple = -1;
+    if (board[boardBase + cell].snake == 0) {
+        MarkFree(game, cell);
+    }
+    int last = appleCount[game] - 1;
+    if (index != last) {
+        appleCell[base + index] = appleCell[base + last];
+        appleType[base + index] = appleType[base + last];
+        appleSpawn[base + index] = appleSpawn[base + last];
+        appleLifetime[base + index] = appleLifetime[base + last];
+        board[boardBase + appleCell[base + index]].apple = (int8_t)index;
+    }
+    appleCount[game]--;
+}
+
+void BatchEngine::SpawnReplacementApples(int game) {
+    if (config.mode == MODE_ACCELERATED) {
+        for (int i = 0; i < 3 && appleCount[game] < GameConstants::MAX_APPLES; i++) {
+            SpawnApple(game, tick[game]);
+        }
+    } else {
+        SpawnApple(game, tick[game]);
+    }
+}
+
+void BatchEngine::UpdateNextEvent(int game, uint32_t now) {
+    if (config.mode != MODE_ACCELERATED) {
+        nextEvent[game] = NEVER;
+        return;
+    }
+    // The despawn timer fires no earlier than the tick after the spawn
+    uint32_t next = NEVER;
+    size_t base = (size_t)game * GameConstants::MAX_APPLES;
+    for (int i = 0; i < appleCount[game]; i++) {
+        next = std::min(next, appleSpawn[base + i] + std::max(appleLifetime[base + i], 1u));
+    }
+    if (appleCount[game] < GameConstants::MIN_APPLES && freeCount[game] > 0) {
+        next = std::min(next, now + 1);
+    }
+    nextEvent[game] = next;
+}
+
+void BatchEngine::RunEvents(int game) {
+    // GameState::UpdateAppleDespawn, for each tick with something to do
+    size_t base = (size_t)game * GameConstants::MAX_APPLES;
+    while (nextEvent[game] <= tick[game]) {
+        uint32_t now = nextEvent[game];
+        // Highest index first, as the swap-removes expect
+        for (int i = appleCount[game] - 1; i >= 0; i--) {
+            if (appleSpawn[base + i] + std::max(appleLifetime[base + i], 1u) == now) {
+                RemoveApple(game, i);
+            }
+        }
+        while (appleCount[game] < GameConstants::MIN_APPLES && SpawnApple(game, now)) {
+        }
+        UpdateNextEvent(game, now);
+    }
+}
+
+void BatchEngine::Consume(int game, int appleIndex) {
+    // GameLogic::HandleAppleConsumption, after the head moved onto the apple
+    FoodType type = (FoodType)appleType[(size_t)game * GameConstants::MAX_APPLES + appleIndex];
+    RemoveApple(game, appleIndex);
+    bool cannotEat = tick[game] < cannotEatEnd[game];
+
+    if (type == POISONOUS) {
+        // The poison pause holds the move timer, which restarts the tick the pause ends
+        nextMove[game] = tick[game] + moveInterval + GameConstants::PAUSE_DURATION - 1;
+        ReverseSnake(game);
+        PopTail(game);
+        dx[game] = -dx[game];
+        dy[game] = -dy[game];
+        cannotEatEnd[game] = tick[game] + GameConstants::CANNOT_EAT_DURATION;
+    } else if (type == TELEPORT) {
+        if (!cannotEat) {
+            Teleport(game);
+        } else {
+            PopTail(game);
+        }
+    } else if (type == POMME_PLUS || type == POMME_SUPREME) {
+        score[game] += 2;
+        PushTail(game, RingAt(game, length[game] - 1));
+        immunityEnd[game] = tick[game] + GameConstants::IMMUNITY_DURATION;
+        if (type == POMME_SUPREME) {
+            wallImmunityEnd[game] = tick[game] + GameConstants::WALL_IMMUNITY_DURATION;
+        }
+    } else {
+        if (!cannotEat) {
+            score[game]++;
+            PushTail(game, RingAt(game, length[game] - 1));
+        } else {
+            PopTail(game);
+        }
+    }
+
+    SpawnReplacementApples(game);
+}
+
+void BatchEngine::Teleport(int game) {
+    int32_t eatenAt = RingAt(game, 0);
+    PopHead(game);
+    int snakeLength = length[game];
+
+    if (freeCount[game] == 0) {
+        // Nowhere to land: move onto the apple's cell without growing
+        PushHead(game, eatenAt);
+        PopTail(game);
+        return;
+    }
+
+    Rng& rng = rngs[game];
+    int32_t landing = FreeCell(game, rng.Range(0, freeCount[game] - 1));
+    int landingCol = landing % width;
+    int landingRow = landing / width;
+    int dirRoll = rng.Range(0, 3);
+    int tx = ACTIONS[dirRoll + 1].dx;
+    int ty = ACTIONS[dirRoll + 1].dy;
+
+    while (length[game] > 0) {
+        PopTail(game);
+    }
+    PushTail(game, landing);
+    for (int i = 1; i < snakeLength; i++) {
+        int col = std::clamp(landingCol - tx * i, 0, width - 1);
+        int row = std::clamp(landingRow - ty * i, 0, height - 1);
+        PushTail(game, row * width + col);
+    }
+
+    dx[game] = 0;
+    dy[game] = 0;
+    movesSinceTeleport[game] = 0;
+}
+
+void BatchEngine::EndGame(int game, DeathCause cause) {
+    if (movesSinceTeleport[game] >= 0 && movesSinceTeleport[game] <= GameConstants::TELEPORT_TRAP_MOVES) {
+        cause = DEATH_TELEPORT_TRAP;
+    }
+    over[game] = 1;
+    deathCause[game] = (uint8_t)cause;
+}
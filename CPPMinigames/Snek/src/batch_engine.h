@@ -0,0 +1,154 @@
+#pragma once
+
+#include "free_cells.h"
+#include "game_types.h"
+#include "rng.h"
+#include <cstdint>
+#include <vector>
+
+// Thousands of independent games stepped in lockstep, one snake move per
+// Step, for self-play and reinforcement learning at scale. Plays exactly
+// like GameState driven by GameLogic::StepToMove: the same seed and
+// actions give the same snake, apples, score and death, tick for tick.
+//
+// Per-game state is kept as structure of arrays (heads, directions,
+// lengths, effect end ticks, apple slots), and effects are end ticks rather
+// than timer wheels, so the ticks between moves cost nothing. Each Step runs
+// flat loops across all games for turning and for moving the head, with the
+// wall wrap, body and apple lookups. Only games that diverge from a plain
+// move are compacted into a list for the scalar slow path. Those are games
+// where an apple despawns before the move, that eat, or that die; teleports
+// and poison reversals happen there. Each game also has its own occupancy
+// counts and free-cell index (FreeCells, as in OccupancyGrid), so random
+// spawns and landings pick the same cells.
+class BatchEngine {
+public:
+    // Actions, as in snake_env: 0 keeps going, 1-4 turn up, down, left, right
+    static constexpr int ACTION_COUNT = 5;
+
+    struct Config {
+        int games = 1024;
+        int boardWidth = GameConstants::GRID_WIDTH;
+        int boardHeight = GameConstants::GRID_HEIGHT;
+        GameMode mode = MODE_REGULAR;
+        GameRules rules;
+    };
+
+    // Allocate every game; each starts over (seed 0) until Reset
+    void Initialize(const Config& config);
+    // Start game `game` over, as GameState::Reset(seed) does
+    void Reset(int game, uint64_t seed);
+
+    // Turn each game that is not over by its action (out-of-range actions
+    // count as 0), then run it up to and including its next move
+    void Step(const uint8_t* actions);
+
+    int Games() const { return games; }
+    int BoardWidth() const { return width; }
+    int BoardHeight() const { return height; }
+
+    bool GameOver(int game) const { return over[game] != 0; }
+    DeathCause GetDeathCause(int game) const { return (DeathCause)deathCause[game]; }
+    int Score(int game) const { return score[game]; }
+    int Length(int game) const { return length[game]; }
+    uint32_t Tick(int game) const { return tick[game]; }
+    Direction Heading(int game) const { return {dx[game], dy[game]}; }
+    // Segment i of the snake (0 is the head)
+    Position Segment(int game, int i) const;
+    int AppleCount(int game) const { return appleCount[game]; }
+    // Apple i, in the same order as GameState::apples (despawnTimer unset)
+    Apple GetApple(int game, int i) const;
+
+private:
+    enum Outcome : uint8_t { OUTCOME_NONE, OUTCOME_STILL, OUTCOME_MOVE, OUTCOME_EAT, OUTCOME_WALL, OUTCOME_SELF };
+
+    struct BoardCell {
+        uint16_t snake;     // Segments covering the cell
+        int8_t apple;       // Index into the game's apple slots, or -1
+    };
+
+    static constexpr uint32_t NEVER = 0xFFFFFFFF;
+
+    // Snake ring (SnakeBody's layout, one slice per game)
+    int32_t& RingAt(int game, int i);
+    void PushHead(int game, int32_t cell);
+    void PopHead(int game);
+    void PushTail(int game, int32_t cell);
+    void PopTail(int game);
+    void ReverseSnake(int game);
+    void GrowRings();
+    void UpdateHead(int game);
+
+    // Board (OccupancyGrid's bookkeeping, one slice per game)
+    void AddSnake(int game, int32_t cell);
+    void RemoveSnake(int game, int32_t cell);
+    void MarkFree(int game, int32_t cell);
+    void MarkTaken(int game, int32_t cell);
+    int32_t FreeCell(int game, int index) const;
+
+    // Apples
+    bool SpawnApple(int game, uint32_t now);
+    void RemoveApple(int game, int index);
+    void SpawnReplacementApples(int game);
+    void UpdateNextEvent(int game, uint32_t now);
+    void RunEvents(int game);
+
+    // Slow path of a move
+    void Consume(int game, int appleIndex);
+    void Teleport(int game);
+    void EndGame(int game, DeathCause cause);
+
+    Config config;
+    int games = 0;
+    int width = 0;
+    int height = 0;
+    int cells = 0;
+    int moveInterval = 0;
+
+    // Per game
+    std::vector<int16_t> headCol;
+    std::vector<int16_t> headRow;
+    std::vector<int8_t> dx;
+    std::vector<int8_t> dy;
+    std::vector<int32_t> length;
+    std::vector<int32_t> score;
+    std::vector<int32_t> movesSinceTeleport;
+    std::vector<uint32_t> tick;             // Also gameTicks: nothing here pauses the game clock
+    std::vector<uint32_t> nextMove;
+    std::vector<uint32_t> nextEvent;        // Next despawn or apple refill (accelerated mode), or NEVER
+    std::vector<uint32_t> immunityEnd;      // Each effect lasts while tick < its end
+    std::vector<uint32_t> wallImmunityEnd;
+    std::vector<uint32_t> cannotEatEnd;
+    std::vector<uint8_t> over;
+    std::vector<uint8_t> deathCause;
+    std::vector<Rng> rngs;
+
+    // Per game snake ring
+    int ringSize = 0;                       // Power of two
+    std::vector<int32_t> ring;
+    std::vector<uint32_t> ringHead;
+    std::vector<uint8_t> ringReversed;
+
+    // Per game apple slots (MAX_APPLES each)
+    std::vector<uint8_t> appleCount;
+    std::vector<int32_t> appleCell;
+    std::vector<uint8_t> appleType;
+    std::vector<uint32_t> appleSpawn;
+    std::vector<uint32_t> appleLifetime;
+
+    // Per game board (cells each). What a move checks and updates at a cell
+    // shares one cache line, unlike OccupancyGrid's separate arrays.
+    std::vector<BoardCell> board;
+    int freeWords = 0;                      // FreeCells::Words(cells)
+    std::vector<uint64_t> freeBits;         // freeWords each
+    std::vector<uint32_t> freeCounts;
+    std::vector<int32_t> freeCount;
+    std::vector<BoardCell> emptyBoard;      // A cleared board and its free index, copied in by Reset
+    std::vector<uint64_t> emptyBits;
+    std::vector<uint32_t> emptyCounts;
+
+    // Step scratch
+    std::vector<int32_t> target;
+    std::vector<uint8_t> outcome;
+    std::vector<int32_t> slow;
+};
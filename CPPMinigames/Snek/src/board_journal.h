@@ -0,0 +1,87 @@
+#pragma once
+
+#include "game_types.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// One change to the snake or the apples, as made through GameState's board helpers
+struct BoardOp {
+    enum Type : uint8_t { PUSH_HEAD, POP_HEAD, PUSH_TAIL, POP_TAIL, REVERSE, ADD_APPLE, REMOVE_APPLE };
+
+    Type type = PUSH_HEAD;
+    FoodType food = REGULAR;    // ADD_APPLE, REMOVE_APPLE
+    int16_t index = 0;          // REMOVE_APPLE
+    Position pos = {0, 0};      // The cell changed (all but REVERSE)
+    uint32_t spawnTick = 0;     // ADD_APPLE
+    uint32_t lifetime = 0;      // ADD_APPLE
+};
+
+// Board changes in the order the rules made them, in a fixed ring. Replaying
+// them onto a copy of an earlier state through the same helpers rebuilds the
+// snake, the apples and the occupancy grid (free-cell order included)
+// exactly. Changes that rewrite the whole board (clearing it, teleporting)
+// break the journal instead, and the reader takes a fresh copy of the state.
+// A reader that keeps its own place in the ring (rather than clearing or
+// mending it) compares Breaks() to tell whether the ops still follow on.
+class BoardJournal {
+public:
+    // Capacity is rounded up to a power of two
+    void Allocate(int capacity) {
+        int size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        ops_.assign(size, BoardOp());
+        mask_ = (uint32_t)size - 1;
+        Clear();
+    }
+    void Clear() {
+        written_ = 0;
+        floor_ = 0;
+        broken_ = false;
+        breaks_++;
+    }
+
+    // Ops are kept while broken too, for readers that picked up again after the break
+    void Push(const BoardOp& op) {
+        ops_[written_ & mask_] = op;
+        written_++;
+    }
+    void Break() {
+        broken_ = true;
+        breaks_++;
+    }
+
+    bool Broken() const { return broken_; }
+    void Mend() { broken_ = false; }
+    // Times the ops stopped following on from the ones before (Break, Clear, Truncate)
+    uint32_t Breaks() const { return breaks_; }
+
+    // Ops are numbered from 0; an op can be read until Capacity() more were written
+    uint32_t Written() const { return written_; }
+    int Capacity() const { return (int)ops_.size(); }
+    bool Holds(uint32_t first) const {
+        return first >= floor_ && written_ - first <= (uint32_t)ops_.size();
+    }
+    const BoardOp& At(uint32_t n) const { return ops_[n & mask_]; }
+
+    // Forget everything after op `end`. The ops written past it may already
+    // have overwritten older ones, so those stay lost.
+    void Truncate(uint32_t end) {
+        if (written_ > (uint32_t)ops_.size()) {
+            floor_ = std::max(floor_, written_ - (uint32_t)ops_.size());
+        }
+        written_ = end;
+        broken_ = false;
+        breaks_++;
+    }
+
+private:
+    std::vector<BoardOp> ops_;
+    uint32_t mask_ = 0;
+    uint32_t written_ = 0;
+    uint32_t floor_ = 0;            // Ops before this were overwritten
+    bool broken_ = false;
+    uint32_t breaks_ = 0;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "game_state.h"
+#include <cstdint>
+
+// Something that plays the game by queueing directions (bots, scripted
+// inputs). Called once before each GameLogic::Step; when it returns true the
+// caller passes the move to GameLogic::QueueDirection.
+class Controller {
+public:
+    virtual ~Controller() = default;
+    
+    // A new game is starting; seed any randomness from here for reproducible runs
+    virtual void NewGame(uint64_t /*seed*/) {}
+    virtual bool ChooseMove(const GameState& state, Direction& move) = 0;
+};
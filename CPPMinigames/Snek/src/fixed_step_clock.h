@@ -0,0 +1,41 @@
+#pragma once
+
+#include "game_types.h"
+#include <cstdint>
+
+// Turns variable frame times into a whole number of fixed simulation ticks.
+// Time is accumulated as integer microseconds scaled by the tick rate, so
+// no remainder is ever lost and long sessions do not drift. A frame can run
+// several ticks or none; backlog beyond maxStepsPerFrame is dropped so a
+// long stall (window drag, breakpoint) does not fast-forward the game.
+class FixedStepClock {
+public:
+    explicit FixedStepClock(int maxStepsPerFrame = 8, int tickRate = GameConstants::TICK_RATE)
+        : maxSteps(maxStepsPerFrame), rate(tickRate) {}
+    
+    // Add one frame's elapsed time; returns how many ticks to run now
+    int Advance(double frameSeconds) {
+        if (frameSeconds > 0.0) {
+            accumulator += (int64_t)(frameSeconds * 1000000.0 + 0.5) * rate;
+        }
+        int64_t steps = accumulator / ONE_SECOND;
+        accumulator -= steps * ONE_SECOND;
+        if (steps > maxSteps) {
+            steps = maxSteps;
+        }
+        return (int)steps;
+    }
+    
+    void Reset() { accumulator = 0; }
+    void SetMaxStepsPerFrame(int steps) { maxSteps = steps; }
+    
+    // Fraction of the next tick already elapsed (0..1), for interpolation
+    float Alpha() const { return (float)accumulator / ONE_SECOND; }
+
+private:
+    static constexpr int64_t ONE_SECOND = 1000000;
+    
+    int maxSteps;
+    int rate;
+    int64_t accumulator = 0;
+};
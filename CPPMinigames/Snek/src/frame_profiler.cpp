@@ -0,0 +1,164 @@
+#include "frame_profiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const char* const PHASE_NAMES[PHASE_COUNT] = {
+        "input",
+        "autopilot",
+        "status_effects",
+        "apple_despawn",
+        "movement",
+        "audio",
+        "draw_mode_selection",
+        "draw_instructions",
+        "draw_game",
+        "draw_arena",
+        "draw_pause",
+        "draw_countdown",
+        "draw_game_over",
+        "draw_arena_game_over",
+        "draw_replay_overlay",
+        "draw_autopilot_badge",
+        "draw_rewind_overlay",
+        "draw_spectator_overlay",
+        "draw_profiler",
+        "present",
+    };
+}
+
+const char* FrameProfiler::PhaseName(ProfilePhase phase) {
+    return PHASE_NAMES[phase];
+}
+
+void FrameProfiler::SetEnabled(bool on) {
+    if (on && samples.empty()) {
+        samples.reserve(WINDOW);
+        sortScratch.reserve(WINDOW);
+        latencies.reserve(LATENCY_WINDOW);
+    }
+    enabled = on;
+    inFrame = false;
+}
+
+void FrameProfiler::BeginFrame() {
+    if (!enabled) {
+        return;
+    }
+    std::fill(current, current + PHASE_COUNT, 0.0f);
+    frameLatency = -1.0f;
+    frameStart = Clock::now();
+    inFrame = true;
+}
+
+void FrameProfiler::EndFrame() {
+    // Skip a frame that was only half timed (the profiler was just switched on)
+    if (!enabled || !inFrame) {
+        return;
+    }
+    inFrame = false;
+
+    Sample sample;
+    sample.frameMicros = std::chrono::duration<float, std::micro>(Clock::now() - frameStart).count();
+    std::copy(current, current + PHASE_COUNT, sample.phaseMicros);
+    if ((int)samples.size() < WINDOW) {
+        samples.push_back(sample);
+    } else {
+        samples[next] = sample;
+    }
+    next = (next + 1) % WINDOW;
+    frameNumber++;
+
+    if (csv) {
+        std::fprintf(csv, "%llu,%.1f", (unsigned long long)frameNumber, sample.frameMicros);
+        for (float micros : sample.phaseMicros) {
+            std::fprintf(csv, ",%.1f", micros);
+        }
+        if (frameLatency >= 0.0f) {
+            std::fprintf(csv, ",%.1f", frameLatency * 1000.0f);
+        } else {
+            std::fputc(',', csv);
+        }
+        std::fputc('\n', csv);
+    }
+
+    if (frameNumber % SUMMARY_INTERVAL == 0) {
+        Summarize();
+    }
+}
+
+void FrameProfiler::AddInputLatency(float millis) {
+    if (!enabled) {
+        return;
+    }
+    if ((int)latencies.size() < LATENCY_WINDOW) {
+        latencies.push_back(millis);
+    } else {
+        latencies[nextLatency] = millis;
+    }
+    nextLatency = (nextLatency + 1) % LATENCY_WINDOW;
+    frameLatency = millis;
+}
+
+void FrameProfiler::Summarize() {
+    Summary result;
+    result.frames = (int)samples.size();
+    if (samples.empty()) {
+        summary = result;
+        return;
+    }
+
+    sortScratch.clear();
+    for (const Sample& sample : samples) {
+        sortScratch.push_back(sample.frameMicros / 1000.0f);
+        int bucket = std::min((int)(sample.frameMicros / 1000.0f / BUCKET_MS), HISTOGRAM_BUCKETS - 1);
+        result.histogram[bucket]++;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            result.phaseAverage[p] += sample.phaseMicros[p];
+            result.phaseMax[p] = std::max(result.phaseMax[p], sample.phaseMicros[p]);
+        }
+    }
+    for (float& average : result.phaseAverage) {
+        average /= result.frames;
+    }
+
+    // Nearest-rank percentiles
+    std::sort(sortScratch.begin(), sortScratch.end());
+    auto percentile = [this](double p) {
+        size_t rank = (size_t)std::ceil(p / 100.0 * sortScratch.size());
+        return sortScratch[rank > 0 ? rank - 1 : 0];
+    };
+    result.frameP50 = percentile(50);
+    result.frameP99 = percentile(99);
+    result.frameMax = sortScratch.back();
+
+    if (!latencies.empty()) {
+        sortScratch.assign(latencies.begin(), latencies.end());
+        std::sort(sortScratch.begin(), sortScratch.end());
+        result.latencyCount = (int)sortScratch.size();
+        result.latencyP50 = percentile(50);
+        result.latencyMax = sortScratch.back();
+    }
+    summary = result;
+}
+
+bool FrameProfiler::OpenCsv(const std::string& path) {
+    CloseCsv();
+    csv = std::fopen(path.c_str(), "w");
+    if (!csv) {
+        return false;
+    }
+    std::fprintf(csv, "frame,frame_us");
+    for (const char* name : PHASE_NAMES) {
+        std::fprintf(csv, ",%s_us", name);
+    }
+    std::fprintf(csv, ",input_latency_us\n");
+    return true;
+}
+
+void FrameProfiler::CloseCsv() {
+    if (csv) {
+        std::fclose(csv);
+        csv = nullptr;
+    }
+}
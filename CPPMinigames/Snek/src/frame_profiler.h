@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Parts of a frame the profiler times. The simulation phases run inside
+// GameLogic::Step (several times per frame when the clock catches up) and
+// add up over the frame.
+enum ProfilePhase {
+    PHASE_INPUT,            // Keyboard polling and queueing
+    PHASE_AUTOPILOT,        // Controller decisions
+    PHASE_STATUS_EFFECTS,   // GameState::UpdateStatusEffects
+    PHASE_APPLE_DESPAWN,    // GameState::UpdateAppleDespawn
+    PHASE_MOVEMENT,         // GameLogic::ProcessMovement (or Arena::Step)
+    PHASE_AUDIO,            // Playing queued sounds and uploading loaded ones
+    // One per Renderer entry point
+    PHASE_DRAW_MODE_SELECTION,
+    PHASE_DRAW_INSTRUCTIONS,
+    PHASE_DRAW_GAME,
+    PHASE_DRAW_ARENA,
+    PHASE_DRAW_PAUSE,
+    PHASE_DRAW_COUNTDOWN,
+    PHASE_DRAW_GAME_OVER,
+    PHASE_DRAW_ARENA_GAME_OVER,
+    PHASE_DRAW_REPLAY_OVERLAY,
+    PHASE_DRAW_AUTOPILOT_BADGE,
+    PHASE_DRAW_REWIND_OVERLAY,
+    PHASE_DRAW_SPECTATOR_OVERLAY,
+    PHASE_DRAW_PROFILER,
+    PHASE_PRESENT,          // EndDrawing: buffer swap, vsync wait and event polling
+    PHASE_COUNT
+};
+
+// Per-frame phase timings for the F3 overlay and CSV export. Keeps the last
+// WINDOW frames and summarizes them every SUMMARY_INTERVAL frames, along
+// with the input latency of the last LATENCY_WINDOW keyboard turns. Timing
+// only happens while the profiler is enabled; a disabled profiler costs a
+// branch per scope.
+class FrameProfiler {
+public:
+    static constexpr int WINDOW = 600;              // 10 s at 60 fps
+    static constexpr int SUMMARY_INTERVAL = 30;
+    static constexpr int HISTOGRAM_BUCKETS = 17;    // 2 ms each, the last one catches everything slower
+    static constexpr float BUCKET_MS = 2.0f;
+    static constexpr int LATENCY_WINDOW = 64;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Summary {
+        int frames = 0;
+        float frameP50 = 0.0f;          // Milliseconds
+        float frameP99 = 0.0f;
+        float frameMax = 0.0f;
+        float phaseAverage[PHASE_COUNT] = {};   // Microseconds per frame
+        float phaseMax[PHASE_COUNT] = {};
+        int histogram[HISTOGRAM_BUCKETS] = {};
+        int latencyCount = 0;           // Keyboard turns measured, up to LATENCY_WINDOW
+        float latencyP50 = 0.0f;        // Milliseconds from the key poll to the move
+        float latencyMax = 0.0f;
+    };
+
+    ~FrameProfiler() { CloseCsv(); }
+
+    void SetEnabled(bool on);
+    bool Enabled() const { return enabled; }
+
+    void BeginFrame();
+    void EndFrame();
+    void Add(ProfilePhase phase, Clock::time_point start) {
+        current[phase] += std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+    }
+
+    // Time from a key press being polled to the move that applied it
+    void AddInputLatency(float millis);
+
+    const Summary& GetSummary() const { return summary; }
+    static const char* PhaseName(ProfilePhase phase);
+
+    // Stream every frame's timings to a CSV file (one row per frame, microseconds)
+    bool OpenCsv(const std::string& path);
+    void CloseCsv();
+    bool CsvOpen() const { return csv != nullptr; }
+
+private:
+    void Summarize();
+
+    struct Sample {
+        float frameMicros;
+        float phaseMicros[PHASE_COUNT];
+    };
+
+    bool enabled = false;
+    bool inFrame = false;
+    Clock::time_point frameStart;
+    float current[PHASE_COUNT] = {};
+    std::vector<Sample> samples;    // Ring buffer of the last WINDOW frames
+    int next = 0;
+    uint64_t frameNumber = 0;
+    Summary summary;
+    std::vector<float> sortScratch;
+    std::vector<float> latencies;   // Ring buffer of the last LATENCY_WINDOW turns
+    int nextLatency = 0;
+    float frameLatency = -1.0f;     // This frame's turn, for the CSV (-1 if none)
+    FILE* csv = nullptr;
+};
+
+// Adds the time until the end of the enclosing scope to a phase; does nothing
+// without an enabled profiler
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler* profiler, ProfilePhase phase)
+        : profiler(profiler && profiler->Enabled() ? profiler : nullptr), phase(phase) {
+        if (this->profiler) {
+            start = FrameProfiler::Clock::now();
+        }
+    }
+    ~ProfileScope() { End(); }
+
+    // Stop timing before the end of the scope
+    void End() {
+        if (profiler) {
+            profiler->Add(phase, start);
+            profiler = nullptr;
+        }
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    FrameProfiler* profiler;
+    ProfilePhase phase;
+    FrameProfiler::Clock::time_point start;
+};
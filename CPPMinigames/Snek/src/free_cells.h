@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+
+// The free cells of a board in row-major order: a bitmap with a bit set per
+// free cell, plus a Fenwick tree of free counts per 64-cell word, so the k-th
+// free cell is found and a cell taken or freed in O(log cells). The order
+// depends only on which cells are free, not on the order they were taken and
+// freed in, so a board rebuilt from its snake and apples alone (a rewind
+// keyframe) picks the same cells as the one it was captured from.
+//
+// The storage belongs to the caller, Words(cells) of each, so BatchEngine can
+// keep every game's slice in one array like the rest of its board.
+namespace FreeCells {
+    inline int Words(int cells) { return (cells + 63) / 64; }
+
+    inline int CountBits(uint64_t bits) {
+        bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+        bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+        bits = (bits + (bits >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return (int)((bits * 0x0101010101010101ull) >> 56);
+    }
+
+    // Every cell free; the bits past the last cell stay clear
+    inline void Fill(uint64_t* bits, uint32_t* counts, int cells) {
+        int words = Words(cells);
+        for (int w = 0; w < words; w++) {
+            int inWord = (cells - w * 64 < 64) ? cells - w * 64 : 64;
+            bits[w] = (inWord == 64) ? ~0ull : (1ull << inWord) - 1;
+            counts[w] = (uint32_t)inWord;
+        }
+        for (int i = 1; i <= words; i++) {
+            int parent = i + (i & -i);
+            if (parent <= words) {
+                counts[parent - 1] += counts[i - 1];
+            }
+        }
+    }
+
+    inline bool Has(const uint64_t* bits, int cell) { return (bits[cell >> 6] >> (cell & 63)) & 1; }
+
+    // Both return false if the cell already was free (taken)
+    inline bool Add(uint64_t* bits, uint32_t* counts, int words, int cell) {
+        uint64_t bit = 1ull << (cell & 63);
+        if (bits[cell >> 6] & bit) {
+            return false;
+        }
+        bits[cell >> 6] |= bit;
+        for (int i = (cell >> 6) + 1; i <= words; i += i & -i) {
+            counts[i - 1]++;
+        }
+        return true;
+    }
+    inline bool Remove(uint64_t* bits, uint32_t* counts, int words, int cell) {
+        uint64_t bit = 1ull << (cell & 63);
+        if (!(bits[cell >> 6] & bit)) {
+            return false;
+        }
+        bits[cell >> 6] &= ~bit;
+        for (int i = (cell >> 6) + 1; i <= words; i += i & -i) {
+            counts[i - 1]--;
+        }
+        return true;
+    }
+
+    // The index-th free cell (0-based, below the free count)
+    inline int Find(const uint64_t* bits, const uint32_t* counts, int words, int index) {
+        uint32_t rank = (uint32_t)index;
+        int word = 0;
+        int step = 1;
+        while (step * 2 <= words) {
+            step *= 2;
+        }
+        for (; step > 0; step >>= 1) {
+            if (word + step <= words && counts[word + step - 1] <= rank) {
+                word += step;
+                rank -= counts[word - 1];
+            }
+        }
+        // Halve the word until one bit is left
+        uint64_t value = bits[word];
+        int bit = 0;
+        for (int width = 32; width > 0; width >>= 1) {
+            int below = CountBits((value >> bit) & ((1ull << width) - 1));
+            if ((int)rank >= below) {
+                rank -= below;
+                bit += width;
+            }
+        }
+        return word * 64 + bit;
+    }
+}
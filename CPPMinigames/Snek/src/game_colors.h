@@ -0,0 +1,21 @@
+#pragma once
+
+// Drawing API: raylib, or its CPU stand-ins for headless rendering
+#ifdef SNAKE_SOFTWARE_RENDER
+#include "soft_raster.h"
+#else
+#include "raylib.h"
+#endif
+
+// Render colors (kept out of game_types.h so the simulation core builds without raylib)
+namespace GameConstants {
+    const Color GRAY_COLOR = {18, 18, 18, 255};
+    const Color SNAKE_COLOR = {50, 150, 50, 255};
+    const Color SNAKE_HEAD_COLOR = {25, 100, 25, 255};
+    const Color POISON_COLOR = {181, 126, 107, 255};
+    const Color GOLD_COLOR = {255, 165, 0, 255};
+    const Color ENCHANTED_GOLD_COLOR = {255, 255, 0, 255};
+    const Color PURPLE_COLOR = {186, 85, 211, 255};
+    const Color BOT_COLOR = {60, 90, 160, 255};
+    const Color BOT_HEAD_COLOR = {35, 55, 110, 255};
+}
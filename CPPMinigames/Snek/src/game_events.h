@@ -0,0 +1,53 @@
+#pragma once
+
+#include "game_types.h"
+#include <cstdint>
+
+// Things the simulation reports to whoever is listening (audio, overlays,
+// tools). The rules only push events; they never call into the front end.
+enum GameEventType {
+    EVENT_ATE_APPLE,        // food; blocked when poison stopped it from scoring or teleporting
+    EVENT_TELEPORTED,       // at: the new head cell
+    EVENT_DIED,             // cause
+    EVENT_EFFECT_EXPIRED,   // timer: the TimerKind that ended the effect
+    EVENT_REMINDER,         // timer: TIMER_POISON_SOUND or TIMER_PAUSE_SOUND came round again
+};
+
+struct GameEvent {
+    GameEventType type;
+    uint32_t tick = 0;              // GameState::tick it happened on
+    FoodType food = REGULAR;
+    bool blocked = false;
+    DeathCause cause = DEATH_NONE;
+    TimerKind timer = TIMER_KIND_COUNT;
+    Position at = {0, 0};
+};
+
+// Fixed-capacity event queue kept in GameState, so pushing never allocates
+// and the queue is copied along with the state. The front end reads it once
+// per frame, handing it to each subscriber in turn, then clears it. Headless
+// runs never read it: once full, further events are dropped and counted.
+class GameEventQueue {
+public:
+    static constexpr int CAPACITY = 64;
+
+    void Push(const GameEvent& event) {
+        if (count_ < CAPACITY) {
+            events_[count_++] = event;
+        } else {
+            dropped_++;
+        }
+    }
+    void Clear() { count_ = 0; }
+
+    int Size() const { return count_; }
+    bool Empty() const { return count_ == 0; }
+    const GameEvent* begin() const { return events_; }
+    const GameEvent* end() const { return events_ + count_; }
+    uint32_t Dropped() const { return dropped_; }
+
+private:
+    GameEvent events_[CAPACITY];
+    int count_ = 0;
+    uint32_t dropped_ = 0;
+};
@@ -1,58 +1,162 @@
 #include "game_logic.h"
 #include "game_types.h"
-#include "raylib.h"
-#include <algorithm>
+#include "frame_profiler.h"
 
-void GameLogic::ProcessMovement(GameState& state, float deltaTime) {
+void GameLogic::Step(GameState& state) {
+    state.tick++;
+    
+    // Update game time (the resume countdown runs on real time, so it can end the pause first)
+    ProfileScope statusScope(state.profiler, PHASE_STATUS_EFFECTS);
+    state.UpdateRealTimers();
+    if (!state.isUserPaused && !state.isResuming) {
+        state.gameTicks++;
+        state.UpdateStatusEffects();
+    }
+    statusScope.End();
+    
+    // Update apple despawn
+    {
+        ProfileScope scope(state.profiler, PHASE_APPLE_DESPAWN);
+        state.UpdateAppleDespawn();
+    }
+    
+    ProfileScope scope(state.profiler, PHASE_MOVEMENT);
+    ProcessMovement(state);
+}
+
+int GameLogic::StepToMove(GameState& state, int maxTicks) {
+    int ticks = 0;
+    while (ticks < maxTicks && !state.gameOver) {
+        bool moves = MovesNextStep(state);
+        Step(state);
+        ticks++;
+        if (moves) {
+            break;
+        }
+    }
+    return ticks;
+}
+
+bool GameLogic::QueueDirection(GameState& state, Direction newDir) {
+    if (state.gameOver || state.isUserPaused || state.isResuming) {
+        return false;
+    }
+    
+    // Ignore reversals into the current direction and repeats of the last queued turn
+    bool isReversal = (newDir.dx != 0 && state.dx == -newDir.dx) ||
+                      (newDir.dy != 0 && state.dy == -newDir.dy);
+    if (((state.dx == 0 && state.dy == 0) || !isReversal) && 
+        (state.directionQueue.empty() || 
+         state.directionQueue.back().dx != newDir.dx || 
+         state.directionQueue.back().dy != newDir.dy)) {
+        state.directionQueue.push_back(newDir);
+        return true;
+    }
+    return false;
+}
+
+bool GameLogic::TogglePause(GameState& state) {
+    if (state.gameOver) {
+        return false;
+    }
+    
+    if (state.isUserPaused) {
+        state.isResuming = true;
+        state.StartTimer(TIMER_RESUME, GameConstants::RESUME_DELAY_DURATION);
+        state.StartTimer(TIMER_PAUSE_SOUND, GameConstants::SOUND_REPEAT_INTERVAL);
+        state.isUserPaused = false;
+        return true;
+    } else if (!state.isResuming) {
+        state.isUserPaused = true;
+        return true;
+    }
+    return false;
+}
+
+void GameLogic::Quit(GameState& state) {
+    state.gameOver = true;
+    state.deathCause = DEATH_QUIT;
+}
+
+void GameLogic::EndGame(GameState& state, DeathCause cause) {
+    if (state.movesSinceTeleport >= 0 && state.movesSinceTeleport <= GameConstants::TELEPORT_TRAP_MOVES) {
+        cause = DEATH_TELEPORT_TRAP;
+    }
+    state.UpdateHighScore();
+    state.gameOver = true;
+    state.deathCause = cause;
+    if (!state.deathReported) {
+        GameEvent died = {EVENT_DIED};
+        died.cause = cause;
+        state.PushEvent(died);
+        state.deathReported = true;
+    }
+}
+
+bool GameLogic::MovesNextStep(const GameState& state) {
+    if (state.gameOver || state.isUserPaused || state.isResuming) {
+        return false;
+    }
+    // A poison pause that ends this tick is cleared before movement runs
+    if (state.isPaused && state.TicksLeft(TIMER_POISON_PAUSE) > 1) {
+        return false;
+    }
+    int moveInterval = (state.gameMode == MODE_ACCELERATED) 
+        ? GameConstants::MOVE_INTERVAL_ACCELERATED 
+        : GameConstants::MOVE_INTERVAL_REGULAR;
+    return state.moveTimer + 1 >= moveInterval;
+}
+
+void GameLogic::ProcessMovement(GameState& state) {
     if (state.gameOver || state.isUserPaused || state.isResuming) {
         return;
     }
     
     // Update movement timer
     if (!state.isPaused && !state.isUserPaused && !state.isResuming) {
-        state.moveTimer += deltaTime;
+        state.moveTimer++;
     }
     
     // Get move interval based on game mode
-    float moveInterval = (state.gameMode == MODE_ACCELERATED) 
+    int moveInterval = (state.gameMode == MODE_ACCELERATED) 
         ? GameConstants::MOVE_INTERVAL_ACCELERATED 
         : GameConstants::MOVE_INTERVAL_REGULAR;
     
     // Process movement when timer elapses
     if (!state.isPaused && !state.isUserPaused && !state.isResuming && 
         state.moveTimer >= moveInterval) {
-        state.moveTimer = 0.0f;
+        state.moveTimer -= moveInterval;
         
         // Process direction queue
         ProcessDirectionQueue(state);
         
         // Move if we have a direction
         if (state.dx != 0 || state.dy != 0) {
-            Position newHead = {state.snake[0].col + state.dx, state.snake[0].row + state.dy};
+            if (state.movesSinceTeleport >= 0) {
+                state.movesSinceTeleport++;
+            }
+            
+            Position head = state.snake.front();
+            Position newHead = {head.col + state.dx, head.row + state.dy};
             
             // Check wall collision
             if (state.canPassWalls) {
                 // Wrap around
                 if (newHead.col < 0) {
-                    newHead.col = GameConstants::GRID_WIDTH - 1;
-                } else if (newHead.col >= GameConstants::GRID_WIDTH) {
+                    newHead.col = state.boardWidth - 1;
+                } else if (newHead.col >= state.boardWidth) {
                     newHead.col = 0;
                 }
                 if (newHead.row < 0) {
-                    newHead.row = GameConstants::GRID_HEIGHT - 1;
-                } else if (newHead.row >= GameConstants::GRID_HEIGHT) {
+                    newHead.row = state.boardHeight - 1;
+                } else if (newHead.row >= state.boardHeight) {
                     newHead.row = 0;
                 }
             } else {
                 // Normal wall collision
-                if (newHead.col < 0 || newHead.col >= GameConstants::GRID_WIDTH || 
-                    newHead.row < 0 || newHead.row >= GameConstants::GRID_HEIGHT) {
-                    state.UpdateHighScore();
-                    state.gameOver = true;
-                    if (!state.gameOverSoundPlayed) {
-                        PlaySound(state.gameOverSound);
-                        state.gameOverSoundPlayed = true;
-                    }
+                if (newHead.col < 0 || newHead.col >= state.boardWidth || 
+                    newHead.row < 0 || newHead.row >= state.boardHeight) {
+                    EndGame(state, DEATH_WALL);
                     return;
                 }
             }
@@ -79,84 +183,76 @@ void GameLogic::ProcessDirectionQueue(GameState& state) {
 
 void GameLogic::CheckCollisions(GameState& state, Position newHead) {
     // Check self collision
-    bool hitSelf = false;
-    if (!state.canIntersectSelf) {
-        for (const auto& segment : state.snake) {
-            if (newHead.col == segment.col && newHead.row == segment.row) {
-                hitSelf = true;
-                break;
-            }
-        }
-    }
+    bool hitSelf = !state.canIntersectSelf && state.grid.HasSnake(newHead.col, newHead.row);
     
     if (hitSelf) {
-        state.snake.insert(state.snake.begin(), newHead);
-        state.UpdateHighScore();
-        state.gameOver = true;
-        if (!state.gameOverSoundPlayed) {
-            PlaySound(state.gameOverSound);
-            state.gameOverSoundPlayed = true;
-        }
+        state.PushHead(newHead);
+        EndGame(state, DEATH_SELF);
         return;
     }
     
     // Check if snake ate any apple
-    int eatenAppleIndex = -1;
-    FoodType eatenFoodType = REGULAR;
-    for (size_t i = 0; i < state.apples.size(); i++) {
-        if (newHead.col == state.apples[i].col && newHead.row == state.apples[i].row) {
-            eatenAppleIndex = i;
-            eatenFoodType = state.apples[i].type;
-            break;
-        }
-    }
+    int eatenAppleIndex = state.grid.AppleAt(newHead.col, newHead.row);
     
     // Move snake
-    state.snake.insert(state.snake.begin(), newHead);
+    state.PushHead(newHead);
     
-    if (eatenAppleIndex >= 0) {
+    if (eatenAppleIndex != OccupancyGrid::NO_APPLE) {
         HandleAppleConsumption(state, eatenAppleIndex);
     } else {
         // Remove tail (snake didn't grow)
-        state.snake.pop_back();
+        state.PopTail();
     }
 }
 
 void GameLogic::HandleAppleConsumption(GameState& state, int eatenAppleIndex) {
     // Remove the eaten apple
     FoodType eatenFoodType = state.apples[eatenAppleIndex].type;
-    state.apples.erase(state.apples.begin() + eatenAppleIndex);
+    state.RemoveApple(eatenAppleIndex);
+    
+    GameEvent ate = {EVENT_ATE_APPLE};
+    ate.food = eatenFoodType;
+    ate.blocked = state.cannotEatApples && (eatenFoodType == REGULAR || eatenFoodType == TELEPORT);
+    state.PushEvent(ate);
     
     if (eatenFoodType == POISONOUS) {
         // Poisonous apple - pause movement and reverse
         state.isPaused = true;
-        state.pauseTimer = GameConstants::PAUSE_DURATION;
+        state.StartTimer(TIMER_POISON_PAUSE, GameConstants::PAUSE_DURATION);
         state.directionQueue.clear();
         
-        std::reverse(state.snake.begin(), state.snake.end());
-        state.snake.pop_back();
+        state.ReverseSnake();
+        state.PopTail();
         
         state.dx = -state.dx;
         state.dy = -state.dy;
         
         state.cannotEatApples = true;
-        state.cannotEatTimer = GameConstants::CANNOT_EAT_DURATION;
-        state.poisonSoundTimer = 1.0f;
+        state.StartTimer(TIMER_CANNOT_EAT, GameConstants::CANNOT_EAT_DURATION);
+        state.StartTimer(TIMER_POISON_SOUND, GameConstants::SOUND_REPEAT_INTERVAL);
     } else if (eatenFoodType == TELEPORT) {
         if (!state.cannotEatApples) {
             // Purple apple - teleport
-            state.snake.erase(state.snake.begin());
+            Position eatenAt = state.snake.front();
+            state.PopHead();
             int snakeLength = state.snake.size();
             
-            int newHeadCol, newHeadRow;
-            bool validTeleportPos = false;
-            do {
-                newHeadCol = GetRandomValue(0, GameConstants::GRID_WIDTH - 1);
-                newHeadRow = GetRandomValue(0, GameConstants::GRID_HEIGHT - 1);
-                validTeleportPos = state.IsValidPosition(newHeadCol, newHeadRow);
-            } while (!validTeleportPos);
+            if (state.grid.FreeCount() == 0) {
+                // Nowhere to land: move onto the apple's cell without growing
+                state.PushHead(eatenAt);
+                state.PopTail();
+                GameEvent teleported = {EVENT_TELEPORTED};
+                teleported.at = eatenAt;
+                state.PushEvent(teleported);
+                SpawnReplacementApples(state);
+                return;
+            }
+            
+            Position landing = state.grid.FreeCell(state.RandomInt(0, state.grid.FreeCount() - 1));
+            int newHeadCol = landing.col;
+            int newHeadRow = landing.row;
             
-            int dirRoll = GetRandomValue(0, 3);
+            int dirRoll = state.RandomInt(0, 3);
             switch (dirRoll) {
                 case 0: state.dx = 0; state.dy = -1; break;
                 case 1: state.dx = 0; state.dy = 1; break;
@@ -164,64 +260,67 @@ void GameLogic::HandleAppleConsumption(GameState& state, int eatenAppleIndex) {
                 case 3: state.dx = 1; state.dy = 0; break;
             }
             
-            state.snake.clear();
-            state.snake.push_back({newHeadCol, newHeadRow});
+            state.ClearSnake();
+            state.PushTail({newHeadCol, newHeadRow});
             
             for (int i = 1; i < snakeLength; i++) {
                 int segCol = newHeadCol - state.dx * i;
                 int segRow = newHeadRow - state.dy * i;
                 
                 if (segCol < 0) segCol = 0;
-                if (segCol >= GameConstants::GRID_WIDTH) segCol = GameConstants::GRID_WIDTH - 1;
+                if (segCol >= state.boardWidth) segCol = state.boardWidth - 1;
                 if (segRow < 0) segRow = 0;
-                if (segRow >= GameConstants::GRID_HEIGHT) segRow = GameConstants::GRID_HEIGHT - 1;
+                if (segRow >= state.boardHeight) segRow = state.boardHeight - 1;
                 
-                state.snake.push_back({segCol, segRow});
+                state.PushTail({segCol, segRow});
             }
             
             state.directionQueue.clear();
             state.dx = 0;
             state.dy = 0;
-            state.moveTimer = 0.0f;
+            state.moveTimer = 0;
+            state.movesSinceTeleport = 0;
             
-            PlaySound(state.purpleSound);
+            GameEvent teleported = {EVENT_TELEPORTED};
+            teleported.at = {newHeadCol, newHeadRow};
+            state.PushEvent(teleported);
         } else {
-            state.snake.pop_back();
+            state.PopTail();
         }
     } else if (eatenFoodType == POMME_PLUS || eatenFoodType == POMME_SUPREME) {
         // Pomme Plus or Pomme Supreme
         state.score += 2;
         state.UpdateHighScore();
         
-        state.snake.push_back(state.snake.back());
+        state.PushTail(state.snake.back());
         state.canIntersectSelf = true;
-        state.immunityTimer = GameConstants::IMMUNITY_DURATION;
+        state.StartTimer(TIMER_IMMUNITY, GameConstants::IMMUNITY_DURATION);
         
         if (eatenFoodType == POMME_SUPREME) {
             state.canPassWalls = true;
-            state.wallImmunityTimer = GameConstants::WALL_IMMUNITY_DURATION;
+            state.StartTimer(TIMER_WALL_IMMUNITY, GameConstants::WALL_IMMUNITY_DURATION);
         }
-        
-        PlaySound(state.goldenSound);
     } else {
         // Regular apple
         if (!state.cannotEatApples) {
             state.score++;
             state.UpdateHighScore();
-            state.snake.push_back(state.snake.back());
-            PlaySound(state.appleSound);
+            state.PushTail(state.snake.back());
         } else {
-            state.snake.pop_back();
+            state.PopTail();
         }
     }
     
+    SpawnReplacementApples(state);
+}
+
+void GameLogic::SpawnReplacementApples(GameState& state) {
     // Spawn new apples
     if (state.gameMode == MODE_ACCELERATED) {
         for (int i = 0; i < 3 && state.apples.size() < GameConstants::MAX_APPLES; i++) {
-            state.SpawnApple(state.gameTime);
+            state.SpawnApple(state.gameTicks);
         }
     } else {
-        state.SpawnApple(state.gameTime);
+        state.SpawnApple(state.gameTicks);
     }
 }
-
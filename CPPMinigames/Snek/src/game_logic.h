@@ -4,9 +4,23 @@
 
 class GameLogic {
 public:
-    static void ProcessMovement(GameState& state, float deltaTime);
+    // Advance the simulation by one fixed tick (timers, effects, despawns and movement)
+    static void Step(GameState& state);
+    // Step up to and including the next tick the snake moves on (or the game
+    // ends), at most maxTicks; returns the ticks run. For stepping by moves.
+    static int StepToMove(GameState& state, int maxTicks);
+    // Return whether the input was accepted (so callers can record it)
+    static bool QueueDirection(GameState& state, Direction newDir);
+    static bool TogglePause(GameState& state);
+    // End the game early (Q)
+    static void Quit(GameState& state);
+    static void ProcessMovement(GameState& state);
+    // Whether the next Step will move the snake (controllers decide on that tick)
+    static bool MovesNextStep(const GameState& state);
     static void HandleAppleConsumption(GameState& state, int eatenAppleIndex);
     static void CheckCollisions(GameState& state, Position newHead);
     static void ProcessDirectionQueue(GameState& state);
+    static void SpawnReplacementApples(GameState& state);
+    static void EndGame(GameState& state, DeathCause cause);
 };
 
@@ -0,0 +1,108 @@
+#include "game_snapshot.h"
+#include <algorithm>
+
+namespace {
+    enum FrameFlag : uint16_t {
+        FLAG_GAME_OVER = 1 << 0,
+        FLAG_MODE_SELECTION = 1 << 1,
+        FLAG_INSTRUCTIONS = 1 << 2,
+        FLAG_INTERSECT_SELF = 1 << 3,
+        FLAG_PASS_WALLS = 1 << 4,
+        FLAG_CANNOT_EAT = 1 << 5,
+        FLAG_PAUSED = 1 << 6,
+        FLAG_USER_PAUSED = 1 << 7,
+        FLAG_RESUMING = 1 << 8,
+        FLAG_DEATH_REPORTED = 1 << 9,
+    };
+}
+
+void SnapshotFrame::Capture(const GameState& state) {
+    tick = state.tick;
+    gameTicks = state.gameTicks;
+    score = state.score;
+    highScoreRegular = state.highScoreRegular;
+    highScoreAccelerated = state.highScoreAccelerated;
+    dx = state.dx;
+    dy = state.dy;
+    moveTimer = state.moveTimer;
+    movesSinceTeleport = state.movesSinceTeleport;
+    selectedModeIndex = state.selectedModeIndex;
+    gameMode = state.gameMode;
+    deathCause = state.deathCause;
+    flags = (state.gameOver ? FLAG_GAME_OVER : 0) |
+            (state.showModeSelection ? FLAG_MODE_SELECTION : 0) |
+            (state.showInstructions ? FLAG_INSTRUCTIONS : 0) |
+            (state.canIntersectSelf ? FLAG_INTERSECT_SELF : 0) |
+            (state.canPassWalls ? FLAG_PASS_WALLS : 0) |
+            (state.cannotEatApples ? FLAG_CANNOT_EAT : 0) |
+            (state.isPaused ? FLAG_PAUSED : 0) |
+            (state.isUserPaused ? FLAG_USER_PAUSED : 0) |
+            (state.isResuming ? FLAG_RESUMING : 0) |
+            (state.deathReported ? FLAG_DEATH_REPORTED : 0);
+    queued = (uint8_t)std::min((int)state.directionQueue.size(), MAX_QUEUED);
+    for (int i = 0; i < queued; i++) {
+        queue[i] = state.directionQueue[i];
+    }
+    for (int kind = 0; kind < TIMER_KIND_COUNT; kind++) {
+        ticksLeft[kind] = state.TicksLeft((TimerKind)kind);
+    }
+    rng = state.rng;
+}
+
+void SnapshotFrame::Apply(GameState& state) const {
+    state.tick = tick;
+    state.gameTicks = gameTicks;
+    state.score = score;
+    state.highScoreRegular = highScoreRegular;
+    state.highScoreAccelerated = highScoreAccelerated;
+    state.dx = dx;
+    state.dy = dy;
+    state.moveTimer = moveTimer;
+    state.movesSinceTeleport = movesSinceTeleport;
+    state.selectedModeIndex = selectedModeIndex;
+    state.gameMode = gameMode;
+    state.deathCause = deathCause;
+    state.gameOver = (flags & FLAG_GAME_OVER) != 0;
+    state.showModeSelection = (flags & FLAG_MODE_SELECTION) != 0;
+    state.showInstructions = (flags & FLAG_INSTRUCTIONS) != 0;
+    state.canIntersectSelf = (flags & FLAG_INTERSECT_SELF) != 0;
+    state.canPassWalls = (flags & FLAG_PASS_WALLS) != 0;
+    state.cannotEatApples = (flags & FLAG_CANNOT_EAT) != 0;
+    state.isPaused = (flags & FLAG_PAUSED) != 0;
+    state.isUserPaused = (flags & FLAG_USER_PAUSED) != 0;
+    state.isResuming = (flags & FLAG_RESUMING) != 0;
+    state.deathReported = (flags & FLAG_DEATH_REPORTED) != 0;
+    state.directionQueue.assign(queue, queue + queued);
+    state.rng = rng;
+    state.RestoreTimers(ticksLeft);
+    state.events.Clear();
+}
+
+void SnapshotBoard::Capture(const GameState& state) {
+    seed = state.seed;
+    snake.assign(state.snake.begin(), state.snake.end());
+    apples.assign(state.apples.begin(), state.apples.end());
+    for (Apple& apple : apples) {
+        apple.despawnTimer = {};    // Rescheduled by SnapshotFrame::Apply
+    }
+}
+
+void SnapshotBoard::Apply(GameState& state) const {
+    BoardJournal* journal = state.journal;
+    if (journal) {
+        journal->Break();
+    }
+    state.journal = nullptr;
+    while (!state.snake.empty()) {
+        state.PopTail();
+    }
+    state.ClearApples();
+    for (const Position& pos : snake) {
+        state.PushTail(pos);
+    }
+    for (const Apple& apple : apples) {
+        state.AddApple(apple);
+    }
+    state.seed = seed;
+    state.journal = journal;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "game_state.h"
+#include <cstdint>
+#include <vector>
+
+// A game's state in two parts that are cheap to take on any board size.
+// SnapshotFrame holds everything but the board in a fixed size (counters,
+// flags, random generator, timers left, queued turns). SnapshotBoard holds
+// the snake's cells and the apples, and restoring it rebuilds the grid; the
+// free-cell order depends only on which cells are free, so the restored game
+// spawns in the same cells. RewindBuffer takes a frame every tick and a board
+// now and then (the journal covers the ticks between); ReplayPlayer takes
+// both at each keyframe.
+struct SnapshotFrame {
+    static constexpr int MAX_QUEUED = 8;    // Queued turns kept; more are dropped
+
+    uint32_t tick;
+    uint32_t gameTicks;
+    int score;
+    int highScoreRegular;
+    int highScoreAccelerated;
+    int dx;
+    int dy;
+    int moveTimer;
+    int movesSinceTeleport;
+    int selectedModeIndex;
+    GameMode gameMode;
+    DeathCause deathCause;
+    uint16_t flags;
+    uint8_t queued;
+    Direction queue[MAX_QUEUED];
+    int ticksLeft[TIMER_KIND_COUNT];
+    Rng rng;
+
+    void Capture(const GameState& state);
+    // Restore after the board; restarts the timers and drops pending events
+    void Apply(GameState& state) const;
+};
+
+struct SnapshotBoard {
+    uint64_t seed = 0;
+    std::vector<Position> snake;    // Head first
+    std::vector<Apple> apples;
+
+    void Capture(const GameState& state);
+    // Empty the board piece by piece (leaving every cell free without
+    // touching the whole grid) and put the snake and apples back. A journal
+    // on the state is told the board jumped.
+    void Apply(GameState& state) const;
+};
@@ -1,60 +1,19 @@
 #include "game_state.h"
-#include "raylib.h"
-#include <ctime>
 #include <algorithm>
-#include <string>
-#include <cstdio>
+#include <functional>
 
-void GameState::Initialize() {
-    // Try to find sounds directory (check multiple possible paths)
-    // This handles different deployment scenarios
-    std::string soundsPath = "sounds/";
-    
-    #ifdef PLATFORM_WEB
-    // On web, preloaded files are at /sounds/
-    soundsPath = "/sounds/";
-    #else
-    // Helper function to check if a path exists (simple check)
-    auto fileExists = [](const char* path) -> bool {
-        FILE* file = fopen(path, "r");
-        if (file) {
-            fclose(file);
-            return true;
-        }
-        return false;
-    };
-    
-    // Try different paths
-    const char* testPaths[] = {
-        "sounds/apple.mp3",           // Same directory as executable
-        "../sounds/apple.mp3",        // Parent directory
-        "../Resources/sounds/apple.mp3", // macOS app bundle
-        "./sounds/apple.mp3",         // Current directory
-    };
-    
-    for (const char* testPath : testPaths) {
-        if (fileExists(testPath)) {
-            // Extract directory path
-            std::string path = testPath;
-            size_t lastSlash = path.find_last_of("/\\");
-            if (lastSlash != std::string::npos) {
-                soundsPath = path.substr(0, lastSlash + 1);
-            }
-            break;
-        }
-    }
-    #endif
-    
-    // Load sound effects (with error checking for web)
-    appleSound = LoadSound((soundsPath + "apple.mp3").c_str());
-    poisonSound = LoadSound((soundsPath + "poison.mp3").c_str());
-    goldenSound = LoadSound((soundsPath + "golden.mp3").c_str());
-    purpleSound = LoadSound((soundsPath + "purple.mp3").c_str());
-    gameOverSound = LoadSound((soundsPath + "gameover.mp3").c_str());
-    pauseSound = LoadSound((soundsPath + "pause.mp3").c_str());
-    
+void GameState::SetBoardSize(int width, int height) {
+    boardWidth = std::clamp(width, GameConstants::MIN_BOARD_SIZE, GameConstants::MAX_BOARD_SIZE);
+    boardHeight = std::clamp(height, GameConstants::MIN_BOARD_SIZE, GameConstants::MAX_BOARD_SIZE);
+}
+
+void GameState::Initialize(uint64_t seed) {
     // Initialize random seed
-    SetRandomSeed((unsigned int)std::time(nullptr));
+    this->seed = seed;
+    rng.Seed(seed);
+    
+    // Small boards reserve room for a full-board snake; giant ones grow on demand
+    snake.reserve(std::min(boardWidth * boardHeight, 1 << 16));
     
     // Don't call Reset() here - we want to show mode selection screen at startup
     // Initialize only what's needed for first startup
@@ -62,47 +21,40 @@ void GameState::Initialize() {
     gameOver = false;
     showModeSelection = true;  // Show mode selection at startup
     showInstructions = false;
-    gameTime = 0.0f;
+    gameTicks = 0;
     selectedModeIndex = 0;
     
     // Initialize snake (will be reset when mode is selected)
-    snake.clear();
-    snake.push_back({GetRandomValue(0, GameConstants::GRID_WIDTH - 1), 
-                     GetRandomValue(0, GameConstants::GRID_HEIGHT - 1)});
+    ClearBoard();
+    PushHead({RandomInt(0, boardWidth - 1), RandomInt(0, boardHeight - 1)});
     
     // Don't initialize apples yet - will be done when mode is selected
-    apples.clear();
     
     // Reset direction and movement
     dx = 0;
     dy = 0;
     directionQueue.clear();
-    moveTimer = 0.0f;
+    moveTimer = 0;
+    tick = 0;
     
     // Reset all timers and effects
+    ClearTimers();
     canIntersectSelf = false;
-    immunityTimer = 0.0f;
     canPassWalls = false;
-    wallImmunityTimer = 0.0f;
     cannotEatApples = false;
-    cannotEatTimer = 0.0f;
     isPaused = false;
-    pauseTimer = 0.0f;
     isUserPaused = false;
     isResuming = false;
-    resumeDelayTimer = 0.0f;
-    poisonSoundTimer = 0.0f;
-    pauseSoundTimer = 0.0f;
-    gameOverSoundPlayed = false;
+    deathReported = false;
+    deathCause = DEATH_NONE;
+    movesSinceTeleport = -1;
+    events.Clear();
 }
 
-void GameState::Cleanup() {
-    UnloadSound(appleSound);
-    UnloadSound(poisonSound);
-    UnloadSound(goldenSound);
-    UnloadSound(purpleSound);
-    UnloadSound(gameOverSound);
-    UnloadSound(pauseSound);
+void GameState::Reset(uint64_t seed) {
+    this->seed = seed;
+    rng.Seed(seed);
+    Reset();
 }
 
 void GameState::Reset() {
@@ -110,189 +62,261 @@ void GameState::Reset() {
     gameOver = false;
     showModeSelection = false;
     showInstructions = false;
-    gameTime = 0.0f;
+    gameTicks = 0;
+    tick = 0;
+    ClearTimers();
     
     // Reset snake
-    snake.clear();
-    snake.push_back({GetRandomValue(0, GameConstants::GRID_WIDTH - 1), 
-                     GetRandomValue(0, GameConstants::GRID_HEIGHT - 1)});
+    ClearBoard();
+    PushHead({RandomInt(0, boardWidth - 1), RandomInt(0, boardHeight - 1)});
     
     // Reset apples
-    apples.clear();
-    if (gameMode == MODE_ACCELERATED) {
-        for (int i = 0; i < 3; i++) {
-            SpawnApple(0.0f);
-        }
-    } else {
-        SpawnApple(0.0f);
-    }
+    SpawnInitialApples();
     
     // Reset direction and movement
     dx = 0;
     dy = 0;
     directionQueue.clear();
-    moveTimer = 0.0f;
+    moveTimer = 0;
     
-    // Reset all timers and effects
+    // Reset all effects (their timers were cleared above)
     canIntersectSelf = false;
-    immunityTimer = 0.0f;
     canPassWalls = false;
-    wallImmunityTimer = 0.0f;
     cannotEatApples = false;
-    cannotEatTimer = 0.0f;
     isPaused = false;
-    pauseTimer = 0.0f;
     isUserPaused = false;
     isResuming = false;
-    resumeDelayTimer = 0.0f;
-    poisonSoundTimer = 0.0f;
-    pauseSoundTimer = 0.0f;
-    gameOverSoundPlayed = false;
+    deathReported = false;
+    deathCause = DEATH_NONE;
+    movesSinceTeleport = -1;
+    events.Clear();
 }
 
-bool GameState::IsValidPosition(int col, int row) const {
-    // Check snake
-    for (const auto& segment : snake) {
-        if (col == segment.col && row == segment.row) {
-            return false;
-        }
-    }
-    // Check existing apples
-    for (const auto& apple : apples) {
-        if (col == apple.col && row == apple.row) {
-            return false;
+void GameState::StartMode(GameMode mode) {
+    gameMode = mode;
+    showModeSelection = false;
+    showInstructions = true;
+    
+    // Initialize apples based on game mode
+    SpawnInitialApples();
+}
+
+void GameState::ReturnToMenu() {
+    gameOver = false;
+    showModeSelection = true;
+    showInstructions = false;
+    score = 0;
+    
+    // Reset game state but keep high scores
+    ClearBoard();
+    dx = 0;
+    dy = 0;
+    directionQueue.clear();
+    moveTimer = 0;
+    tick = 0;
+    gameTicks = 0;
+    ClearTimers();
+    canIntersectSelf = false;
+    canPassWalls = false;
+    cannotEatApples = false;
+    isPaused = false;
+    isUserPaused = false;
+    isResuming = false;
+    deathReported = false;
+    deathCause = DEATH_NONE;
+    movesSinceTeleport = -1;
+    events.Clear();
+}
+
+void GameState::Replay(const BoardOp& op) {
+    switch (op.type) {
+        case BoardOp::PUSH_HEAD:
+            PushHead(op.pos);
+            break;
+        case BoardOp::POP_HEAD:
+            PopHead();
+            break;
+        case BoardOp::PUSH_TAIL:
+            PushTail(op.pos);
+            break;
+        case BoardOp::POP_TAIL:
+            PopTail();
+            break;
+        case BoardOp::REVERSE:
+            ReverseSnake();
+            break;
+        case BoardOp::ADD_APPLE: {
+            Apple apple = {};
+            apple.col = op.pos.col;
+            apple.row = op.pos.row;
+            apple.type = op.food;
+            apple.spawnTick = op.spawnTick;
+            apple.lifetime = op.lifetime;
+            AddApple(apple);
+            break;
         }
+        case BoardOp::REMOVE_APPLE:
+            RemoveApple(op.index);
+            break;
     }
-    return true;
 }
 
-FoodType GameState::GetRandomFoodType() const {
-    int foodRoll = GetRandomValue(1, 100);
-    if (foodRoll <= 4) {
-        return POMME_PLUS;
-    } else if (foodRoll <= 5) {
-        return POMME_SUPREME;
-    } else if (foodRoll <= 15) {
-        return POISONOUS;
-    } else if (foodRoll <= 18) {
-        return TELEPORT;
-    } else {
-        return REGULAR;
-    }
+bool GameState::IsValidPosition(int col, int row) const {
+    // Free of both snake segments and apples
+    return grid.IsFree(col, row);
 }
 
-bool GameState::SpawnApple(float currentTime) {
+FoodType GameState::GetRandomFoodType() {
+    return rules.RollFood(rng);
+}
+
+bool GameState::SpawnApple(uint32_t currentTick) {
     if (apples.size() >= GameConstants::MAX_APPLES) {
         return false;
     }
     
-    // Try to find a valid position (max 100 attempts)
-    int attempts = 0;
-    int col, row;
-    do {
-        col = GetRandomValue(0, GameConstants::GRID_WIDTH - 1);
-        row = GetRandomValue(0, GameConstants::GRID_HEIGHT - 1);
-        attempts++;
-    } while (!IsValidPosition(col, row) && attempts < 100);
-    
-    if (attempts >= 100) {
+    // Pick uniformly among the free cells
+    if (grid.FreeCount() == 0) {
         return false;
     }
+    Position pos = grid.FreeCell(RandomInt(0, grid.FreeCount() - 1));
     
     Apple newApple;
-    newApple.col = col;
-    newApple.row = row;
+    newApple.col = pos.col;
+    newApple.row = pos.row;
     newApple.type = GetRandomFoodType();
-    newApple.spawnTime = currentTime;
-    newApple.despawnTime = GetRandomValue(GameConstants::DESPAWN_TIME_MIN, 
-                                          GameConstants::DESPAWN_TIME_MAX);
-    apples.push_back(newApple);
+    newApple.spawnTick = currentTick;
+    newApple.lifetime = RandomInt(rules.despawnTimeMin, rules.despawnTimeMax) * GameConstants::TICK_RATE;
+    if (gameMode == MODE_ACCELERATED) {
+        newApple.despawnTimer = gameTimers.Schedule(currentTick + newApple.lifetime, TIMER_APPLE_DESPAWN,
+                                                    (uint32_t)(pos.row * boardWidth + pos.col));
+    }
+    AddApple(newApple);
     return true;
 }
 
-void GameState::UpdateStatusEffects(float deltaTime) {
-    if (canIntersectSelf) {
-        immunityTimer -= deltaTime;
-        if (immunityTimer <= 0.0f) {
-            canIntersectSelf = false;
-            immunityTimer = 0.0f;
+void GameState::SpawnInitialApples() {
+    ClearApples();
+    if (gameMode == MODE_ACCELERATED) {
+        for (int i = 0; i < 3; i++) {
+            SpawnApple(0);
         }
+    } else {
+        SpawnApple(0);
     }
-    
-    if (cannotEatApples) {
-        cannotEatTimer -= deltaTime;
-        
-        poisonSoundTimer -= deltaTime;
-        if (poisonSoundTimer <= 0.0f) {
-            PlaySound(poisonSound);
-            poisonSoundTimer = 1.0f;
-        }
-        
-        if (cannotEatTimer <= 0.0f) {
-            cannotEatApples = false;
-            cannotEatTimer = 0.0f;
-            poisonSoundTimer = 0.0f;
+}
+
+void GameState::StartTimer(TimerKind kind, int ticks) {
+    TimerWheel& wheel = IsRealTime(kind) ? realTimers : gameTimers;
+    uint32_t now = IsRealTime(kind) ? tick : gameTicks;
+    wheel.Cancel(timers[kind]);
+    timers[kind] = wheel.Schedule(now + ticks, kind);
+}
+
+void GameState::StopTimer(TimerKind kind) {
+    (IsRealTime(kind) ? realTimers : gameTimers).Cancel(timers[kind]);
+}
+
+int GameState::TicksLeft(TimerKind kind) const {
+    return (IsRealTime(kind) ? realTimers : gameTimers).TicksLeft(timers[kind]);
+}
+
+void GameState::ClearTimers() {
+    gameTimers.Clear(gameTicks);
+    realTimers.Clear(tick);
+    for (TimerHandle& handle : timers) {
+        handle = TimerHandle();
+    }
+    expiredApples.clear();
+}
+
+void GameState::RestoreTimers(const int ticksLeft[TIMER_KIND_COUNT]) {
+    ClearTimers();
+    for (int kind = 0; kind < TIMER_KIND_COUNT; kind++) {
+        if (ticksLeft[kind] > 0) {
+            StartTimer((TimerKind)kind, ticksLeft[kind]);
         }
-    } else {
-        poisonSoundTimer = 0.0f;
     }
-    
-    if (canPassWalls) {
-        wallImmunityTimer -= deltaTime;
-        if (wallImmunityTimer <= 0.0f) {
-            canPassWalls = false;
-            wallImmunityTimer = 0.0f;
+    if (gameMode == MODE_ACCELERATED) {
+        for (Apple& apple : apples) {
+            apple.despawnTimer = gameTimers.Schedule(apple.spawnTick + apple.lifetime, TIMER_APPLE_DESPAWN,
+                                                     (uint32_t)(apple.row * boardWidth + apple.col));
         }
     }
-    
-    if (isPaused) {
-        pauseTimer -= deltaTime;
-        if (pauseTimer <= 0.0f) {
+}
+
+void GameState::RunTimer(const TimerWheel::Event& event) {
+    switch (event.kind) {
+        case TIMER_IMMUNITY:
+            canIntersectSelf = false;
+            break;
+        case TIMER_POISON_SOUND:
+        case TIMER_PAUSE_SOUND:
+            StartTimer((TimerKind)event.kind, GameConstants::SOUND_REPEAT_INTERVAL);
+            break;
+        case TIMER_CANNOT_EAT:
+            cannotEatApples = false;
+            StopTimer(TIMER_POISON_SOUND);
+            break;
+        case TIMER_WALL_IMMUNITY:
+            canPassWalls = false;
+            break;
+        case TIMER_POISON_PAUSE:
             isPaused = false;
-            pauseTimer = 0.0f;
-        }
+            break;
+        case TIMER_APPLE_DESPAWN:
+            expiredApples.push_back(grid.AppleAt(event.payload % boardWidth, event.payload / boardWidth));
+            return;
+        case TIMER_RESUME:
+            isResuming = false;
+            StopTimer(TIMER_PAUSE_SOUND);
+            break;
     }
     
-    if (isResuming) {
-        resumeDelayTimer -= deltaTime;
-        
-        pauseSoundTimer -= deltaTime;
-        if (pauseSoundTimer <= 0.0f) {
-            PlaySound(pauseSound);
-            pauseSoundTimer = 1.0f;
-        }
-        
-        if (resumeDelayTimer <= 0.0f) {
-            isResuming = false;
-            resumeDelayTimer = 0.0f;
-            pauseSoundTimer = 0.0f;
-        }
-    } else {
-        pauseSoundTimer = 0.0f;
+    GameEvent report = {(event.kind == TIMER_POISON_SOUND || event.kind == TIMER_PAUSE_SOUND) ?
+                        EVENT_REMINDER : EVENT_EFFECT_EXPIRED};
+    report.timer = (TimerKind)event.kind;
+    PushEvent(report);
+}
+
+void GameState::UpdateRealTimers() {
+    firedTimers.clear();
+    realTimers.Advance(tick, firedTimers);
+    for (const TimerWheel::Event& event : firedTimers) {
+        RunTimer(event);
+    }
+}
+
+void GameState::UpdateStatusEffects() {
+    // Only the events due this tick are visited, however many are pending
+    firedTimers.clear();
+    gameTimers.Advance(gameTicks, firedTimers);
+    for (const TimerWheel::Event& event : firedTimers) {
+        RunTimer(event);
     }
 }
 
-void GameState::UpdateAppleDespawn(float deltaTime) {
+void GameState::UpdateAppleDespawn() {
     if (gameMode != MODE_ACCELERATED) {
         return;
     }
     
-    // Remove apples that have exceeded their despawn time
-    auto it = apples.begin();
-    while (it != apples.end()) {
-        float elapsed = gameTime - it->spawnTime;
-        if (elapsed >= it->despawnTime) {
-            it = apples.erase(it);
-        } else {
-            ++it;
+    // Remove the apples whose despawn fired, highest index first so the
+    // swap-removes don't move the ones still to go
+    if (!expiredApples.empty()) {
+        std::sort(expiredApples.begin(), expiredApples.end(), std::greater<int>());
+        for (int index : expiredApples) {
+            if (index != OccupancyGrid::NO_APPLE) {
+                RemoveApple(index);
+            }
         }
+        expiredApples.clear();
     }
     
     // Ensure at least MIN_APPLES apples are on the board
     while (apples.size() < GameConstants::MIN_APPLES) {
-        if (!SpawnApple(gameTime)) {
+        if (!SpawnApple(gameTicks)) {
             break;
         }
     }
 }
-
@@ -1,10 +1,17 @@
 #pragma once
 
 #include "game_types.h"
-#include "raylib.h"
+#include "game_events.h"
+#include "board_journal.h"
+#include "occupancy_grid.h"
+#include "snake_body.h"
+#include "rng.h"
+#include <cstdint>
 #include <vector>
 #include <deque>
 
+class FrameProfiler;
+
 class GameState {
 public:
     // Game mode and screens
@@ -12,8 +19,12 @@ public:
     bool showModeSelection = true;
     bool showInstructions = false;
     bool gameOver = false;
+    DeathCause deathCause = DEATH_NONE;
     int selectedModeIndex = 0;
     
+    // Spawn weights and despawn times (headless tools tune these; the game uses the defaults)
+    GameRules rules;
+    
     // Score
     int score = 0;
     int highScoreRegular = 0;
@@ -37,57 +48,172 @@ public:
         }
     }
     
-    // Snake
-    std::vector<Position> snake;
+    // Board size in cells; set with SetBoardSize before Initialize or Reset
+    int boardWidth = GameConstants::GRID_WIDTH;
+    int boardHeight = GameConstants::GRID_HEIGHT;
+    
+    // Snake (index 0 is the head)
+    SnakeBody snake;
     int dx = 0;
     int dy = 0;
     std::deque<Direction> directionQueue;
-    float moveTimer = 0.0f;
+    int moveTimer = 0;              // Ticks since the last move
+    int movesSinceTeleport = -1;    // -1 until the first teleport
+    
+    // Simulation steps (GameLogic::Step calls) since the last Reset
+    uint32_t tick = 0;
     
     // Apples
     std::vector<Apple> apples;
-    float gameTime = 0.0f;
+    uint32_t gameTicks = 0;         // Unpaused ticks since the game started
+    
+    // Cell occupancy mirror of snake and apples; only mutate them through the helpers below
+    OccupancyGrid grid;
     
-    // Status effects
+    // Records every change the helpers make when set (the rewind buffer's,
+    // which the spectator stream reads too; front end only)
+    BoardJournal* journal = nullptr;
+    
+    void PushHead(Position pos) {
+        snake.push_front(pos);
+        grid.AddSnake(pos);
+        if (journal) journal->Push({BoardOp::PUSH_HEAD, REGULAR, 0, pos});
+    }
+    void PopHead() {
+        if (journal) journal->Push({BoardOp::POP_HEAD, REGULAR, 0, snake.front()});
+        grid.RemoveSnake(snake.front());
+        snake.pop_front();
+    }
+    void PushTail(Position pos) {
+        snake.push_back(pos);
+        grid.AddSnake(pos);
+        if (journal) journal->Push({BoardOp::PUSH_TAIL, REGULAR, 0, pos});
+    }
+    void PopTail() {
+        if (journal) journal->Push({BoardOp::POP_TAIL, REGULAR, 0, snake.back()});
+        grid.RemoveSnake(snake.back());
+        snake.pop_back();
+    }
+    void ReverseSnake() {
+        snake.reverse();
+        if (journal) journal->Push({BoardOp::REVERSE});
+    }
+    void ClearSnake() {
+        if (journal) journal->Break();
+        while (!snake.empty()) {
+            PopTail();
+        }
+    }
+    void AddApple(const Apple& apple) {
+        grid.SetApple(apple.col, apple.row, (int)apples.size());
+        apples.push_back(apple);
+        if (journal) {
+            journal->Push({BoardOp::ADD_APPLE, apple.type, 0, {apple.col, apple.row}, apple.spawnTick, apple.lifetime});
+        }
+    }
+    // Swap-removes the apple, so indices of later apples may change
+    void RemoveApple(int index) {
+        if (journal) {
+            const Apple& apple = apples[index];
+            journal->Push({BoardOp::REMOVE_APPLE, apple.type, (int16_t)index, {apple.col, apple.row}});
+        }
+        gameTimers.Cancel(apples[index].despawnTimer);
+        grid.ClearApple(apples[index].col, apples[index].row);
+        if (index != (int)apples.size() - 1) {
+            apples[index] = apples.back();
+            grid.SetApple(apples[index].col, apples[index].row, index);
+        }
+        apples.pop_back();
+    }
+    void ClearApples() {
+        while (!apples.empty()) {
+            RemoveApple((int)apples.size() - 1);
+        }
+    }
+    // Makes a journalled change again (rewinding, mirroring a spectated game)
+    void Replay(const BoardOp& op);
+    void ClearBoard() {
+        if (journal) journal->Break();
+        snake.clear();
+        apples.clear();
+        if (grid.Width() != boardWidth || grid.Height() != boardHeight) {
+            grid.Resize(boardWidth, boardHeight);
+        } else {
+            grid.Clear();
+        }
+    }
+    
+    // Status effects (each one ends with an event on the timer wheels below)
     bool canIntersectSelf = false;
-    float immunityTimer = 0.0f;
     bool canPassWalls = false;
-    float wallImmunityTimer = 0.0f;
     bool cannotEatApples = false;
-    float cannotEatTimer = 0.0f;
     
     // Pause states
     bool isPaused = false;
-    float pauseTimer = 0.0f;
     bool isUserPaused = false;
     bool isResuming = false;
-    float resumeDelayTimer = 0.0f;
-    
-    // Sound timers
-    float poisonSoundTimer = 0.0f;
-    float pauseSoundTimer = 0.0f;
-    bool gameOverSoundPlayed = false;
-    
-    // Sounds
-    Sound appleSound;
-    Sound poisonSound;
-    Sound goldenSound;
-    Sound purpleSound;
-    Sound gameOverSound;
-    Sound pauseSound;
-    
-    // Initialization
-    void Initialize();
-    void Cleanup();
+    
+    // Timed events. gameTimers runs on gameTicks, so it stops while the game
+    // is paused; realTimers runs on tick and drives the resume countdown. A
+    // new timed effect only needs a TimerKind and a case in RunTimer.
+    TimerWheel gameTimers;
+    TimerWheel realTimers;
+    TimerHandle timers[TIMER_KIND_COUNT];   // Pending event of each kind (apple despawns are per apple)
+    std::vector<TimerWheel::Event> firedTimers;
+    std::vector<int> expiredApples;         // Indices despawning this tick
+    
+    // (Re)start the event of the given kind `ticks` from now, replacing a pending one
+    void StartTimer(TimerKind kind, int ticks);
+    void StopTimer(TimerKind kind);
+    // Ticks until the event of the given kind fires, or 0 if none is pending
+    int TicksLeft(TimerKind kind) const;
+    // Rebuild both wheels from each kind's ticks left (see TicksLeft) and the
+    // apples' own despawn times, after the state was restored from a snapshot
+    void RestoreTimers(const int ticksLeft[TIMER_KIND_COUNT]);
+    
+    bool deathReported = false;
+    
+    // Events since the front end last drained the queue
+    GameEventQueue events;
+    
+    void PushEvent(GameEventType type) { events.Push({type, tick}); }
+    void PushEvent(GameEvent event) {
+        event.tick = tick;
+        events.Push(event);
+    }
+    
+    // Times the simulation phases of each Step when set (front end only; not part of the game)
+    FrameProfiler* profiler = nullptr;
+    
+    // Per-game random number generator; every random roll in the rules draws from it
+    Rng rng;
+    uint64_t seed = 0;
+    
+    // Random integer in [min, max], inclusive like GetRandomValue
+    int RandomInt(int min, int max) { return rng.Range(min, max); }
+    
+    // Initialization (the same seed, board size and inputs always reproduce the same game)
+    void SetBoardSize(int width, int height);
+    void Initialize(uint64_t seed);
     void Reset();
+    void Reset(uint64_t seed);
+    void StartMode(GameMode mode);
+    void ReturnToMenu();
     
     // Apple management
     bool IsValidPosition(int col, int row) const;
-    FoodType GetRandomFoodType() const;
-    bool SpawnApple(float currentTime);
+    FoodType GetRandomFoodType();
+    bool SpawnApple(uint32_t currentTick);
+    void SpawnInitialApples();
+    
+    // Timer updates: UpdateRealTimers every tick, UpdateStatusEffects once per game tick
+    void UpdateRealTimers();
+    void UpdateStatusEffects();
+    void UpdateAppleDespawn();
     
-    // Status effect updates
-    void UpdateStatusEffects(float deltaTime);
-    void UpdateAppleDespawn(float deltaTime);
+private:
+    static bool IsRealTime(TimerKind kind) { return kind == TIMER_PAUSE_SOUND || kind == TIMER_RESUME; }
+    void ClearTimers();
+    void RunTimer(const TimerWheel::Event& event);
 };
 
@@ -1,6 +1,8 @@
 #pragma once
 
-#include "raylib.h"
+#include "rng.h"
+#include "timer_wheel.h"
+#include <cstdint>
 #include <vector>
 
 struct Position {
@@ -16,12 +18,42 @@ struct Direction {
 enum FoodType { REGULAR, POISONOUS, POMME_PLUS, POMME_SUPREME, TELEPORT };
 enum GameMode { MODE_REGULAR, MODE_ACCELERATED };
 
+// Why a game ended (DEATH_TELEPORT_TRAP is a wall or self hit within a few
+// moves of a teleport, i.e. the teleport dropped the snake somewhere hopeless)
+enum DeathCause { DEATH_NONE, DEATH_WALL, DEATH_SELF, DEATH_TELEPORT_TRAP, DEATH_QUIT };
+
+// Sounds the front end plays for game events
+enum SoundEffect {
+    SOUND_APPLE,
+    SOUND_POISON,
+    SOUND_GOLDEN,
+    SOUND_PURPLE,
+    SOUND_GAME_OVER,
+    SOUND_PAUSE,
+    SOUND_COUNT
+};
+
+// Events on GameState's timer wheels. Events due on the same tick fire in
+// this order.
+enum TimerKind {
+    TIMER_IMMUNITY,         // Self-intersection immunity ends
+    TIMER_POISON_SOUND,     // Repeating reminder while apples can't be eaten
+    TIMER_CANNOT_EAT,       // Poison wears off
+    TIMER_WALL_IMMUNITY,    // Wall passing ends
+    TIMER_POISON_PAUSE,     // Poison freeze ends
+    TIMER_APPLE_DESPAWN,    // Accelerated-mode apple expires (payload: its cell index)
+    TIMER_PAUSE_SOUND,      // Repeating tick during the resume countdown
+    TIMER_RESUME,           // Resume countdown ends
+    TIMER_KIND_COUNT
+};
+
 struct Apple {
     int col;
     int row;
     FoodType type;
-    float spawnTime;
-    float despawnTime;
+    uint32_t spawnTick;     // GameState::gameTicks when spawned
+    uint32_t lifetime;      // Ticks until it despawns (accelerated mode)
+    TimerHandle despawnTimer = {};
 };
 
 // Game constants
@@ -31,35 +63,75 @@ namespace GameConstants {
     const int SCREEN_WIDTH = 720;
     const int SCREEN_HEIGHT = BOARD_SIZE + SCORE_AREA_HEIGHT;
     const int CELL_SIZE = 30;
-    const int GRID_WIDTH = (BOARD_SIZE / CELL_SIZE) - 2;
-    const int GRID_HEIGHT = (BOARD_SIZE / CELL_SIZE) - 2;
     const int BORDER_OFFSET = 1;
     const int BOARD_START_Y = SCORE_AREA_HEIGHT;
+    
+    // Cells that fit in the on-screen board area, border included
     const int TOTAL_GRID_WIDTH = BOARD_SIZE / CELL_SIZE;
     const int TOTAL_GRID_HEIGHT = BOARD_SIZE / CELL_SIZE;
     
-    // Colors
-    const Color GRAY_COLOR = {18, 18, 18, 255};
-    const Color SNAKE_COLOR = {50, 150, 50, 255};
-    const Color SNAKE_HEAD_COLOR = {25, 100, 25, 255};
-    const Color POISON_COLOR = {181, 126, 107, 255};
-    const Color GOLD_COLOR = {255, 165, 0, 255};
-    const Color ENCHANTED_GOLD_COLOR = {255, 255, 0, 255};
-    const Color PURPLE_COLOR = {186, 85, 211, 255};
+    // Default board, which fills the screen exactly; larger boards scroll with the head
+    const int GRID_WIDTH = TOTAL_GRID_WIDTH - 2;
+    const int GRID_HEIGHT = TOTAL_GRID_HEIGHT - 2;
+    const int MIN_BOARD_SIZE = 4;
+    const int MAX_BOARD_SIZE = 4096;
     
-    // Game timing
-    const float MOVE_INTERVAL_REGULAR = 0.25f;
-    const float MOVE_INTERVAL_ACCELERATED = 0.20f;
-    const float IMMUNITY_DURATION = 10.0f;
-    const float WALL_IMMUNITY_DURATION = 10.0f;
-    const float CANNOT_EAT_DURATION = 10.0f;
-    const float PAUSE_DURATION = 0.5f;
-    const float RESUME_DELAY_DURATION = 2.0f;
+    // Game timing (the simulation runs at a fixed TICK_RATE; durations are in ticks)
+    const int TICK_RATE = 60;
+    const int MOVE_INTERVAL_REGULAR = TICK_RATE / 4;        // 0.25s
+    const int MOVE_INTERVAL_ACCELERATED = TICK_RATE / 5;    // 0.20s
+    const int IMMUNITY_DURATION = 10 * TICK_RATE;
+    const int WALL_IMMUNITY_DURATION = 10 * TICK_RATE;
+    const int CANNOT_EAT_DURATION = 10 * TICK_RATE;
+    const int PAUSE_DURATION = TICK_RATE / 2;
+    const int RESUME_DELAY_DURATION = 2 * TICK_RATE;
+    const int SOUND_REPEAT_INTERVAL = TICK_RATE;
+    
+    // Rewind (hold BACKSPACE) and retry (T after a game over)
+    const int REWIND_SECONDS = 10;      // History kept
+    const int REWIND_SPEED = 2;         // Ticks rewound per frame while held
+    const int RETRY_SECONDS = 5;
+    
+    // Whole seconds left on a tick countdown, for on-screen timers
+    inline int CeilSeconds(int ticks) { return (ticks + TICK_RATE - 1) / TICK_RATE; }
     
     // Apple settings
     const int MAX_APPLES = 12;
     const int MIN_APPLES = 2;
-    const int DESPAWN_TIME_MIN = 13;
+    const int DESPAWN_TIME_MIN = 13;    // Seconds
     const int DESPAWN_TIME_MAX = 18;
+    
+    // Deaths this many moves after a teleport count as DEATH_TELEPORT_TRAP
+    const int TELEPORT_TRAP_MOVES = 3;
 }
 
+// Tunable rule parameters; the defaults are the shipped game
+struct GameRules {
+    // Spawn chance of each FoodType, as relative weights (shipped: percentages)
+    int foodWeights[5] = {82, 10, 4, 1, 3};
+    int despawnTimeMin = GameConstants::DESPAWN_TIME_MIN;     // Seconds
+    int despawnTimeMax = GameConstants::DESPAWN_TIME_MAX;
+    
+    // Type of a new apple. Rolled in the same order as the original fixed
+    // percentages, so the default weights draw exactly the same apples.
+    FoodType RollFood(Rng& rng) const {
+        const FoodType order[5] = {POMME_PLUS, POMME_SUPREME, POISONOUS, TELEPORT, REGULAR};
+        int total = 0;
+        for (FoodType type : order) {
+            total += foodWeights[type];
+        }
+        if (total <= 0) {
+            return REGULAR;
+        }
+        
+        int foodRoll = rng.Range(1, total);
+        for (FoodType type : order) {
+            foodRoll -= foodWeights[type];
+            if (foodRoll <= 0) {
+                return type;
+            }
+        }
+        return REGULAR;
+    }
+};
+
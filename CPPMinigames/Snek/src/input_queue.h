@@ -0,0 +1,97 @@
+#pragma once
+
+#include "game_logic.h"
+#include "game_state.h"
+#include <chrono>
+#include <deque>
+
+// Direction key presses between frames, kept in the order they were pressed
+// (two taps in one frame both count) and stamped with the time the window's
+// events were polled, which is the closest the platform layer gets to the
+// press itself. Every tick a frame catches up on covers time before that
+// poll, so the presses belong to the frame's last tick and are queued just
+// before it.
+//
+// Also follows each queued turn through GameState::directionQueue to the
+// tick the snake moves on it, and reports the time from the poll to then.
+class InputQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // A direction key press seen by the poll at `polled`
+    void Press(Direction dir, Clock::time_point polled) {
+        presses.push_back({dir, polled});
+    }
+    bool HasPresses() const { return !presses.empty(); }
+
+    // Queue the next press the game accepts, skipping rejected ones (a
+    // reversal or a repeat); returns false once none are left
+    bool QueueNext(GameState& state, Direction& queued) {
+        while (!presses.empty()) {
+            Pending press = presses.front();
+            presses.pop_front();
+            if (GameLogic::QueueDirection(state, press.dir)) {
+                queued = press.dir;
+                turns.push_back({true, press.polled});
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Take the next press as it came, for modes that queue turns themselves (the arena)
+    bool NextPress(Direction& dir) {
+        if (presses.empty()) {
+            return false;
+        }
+        dir = presses.front().dir;
+        presses.pop_front();
+        return true;
+    }
+
+    // A turn queued by something other than the keyboard (the autopilot)
+    void QueuedUntimed() { turns.push_back({false, Clock::time_point()}); }
+
+    // Bracket each GameLogic::Step. AfterStep returns true, with the delay in
+    // milliseconds, when a keyboard turn was applied by that tick's move.
+    void BeforeStep(const GameState& state) {
+        queuedBefore = state.directionQueue.size();
+        movesThisStep = GameLogic::MovesNextStep(state);
+    }
+    bool AfterStep(const GameState& state, float& latencyMillis) {
+        bool measured = false;
+        if (movesThisStep && queuedBefore > 0 && !turns.empty()) {
+            if (turns.front().timed) {
+                latencyMillis = std::chrono::duration<float, std::milli>(Clock::now() - turns.front().polled).count();
+                measured = true;
+            }
+            turns.pop_front();
+        }
+        // Poison, teleports and resets empty the game's queue
+        while (turns.size() > state.directionQueue.size()) {
+            turns.pop_front();
+        }
+        return measured;
+    }
+
+    // Forget everything (new game, rewind)
+    void Clear() {
+        presses.clear();
+        turns.clear();
+    }
+
+private:
+    struct Pending {
+        Direction dir;
+        Clock::time_point polled;
+    };
+    struct Turn {
+        bool timed;
+        Clock::time_point polled;
+    };
+
+    std::deque<Pending> presses;
+    std::deque<Turn> turns;     // Mirrors GameState::directionQueue
+    size_t queuedBefore = 0;
+    bool movesThisStep = false;
+};
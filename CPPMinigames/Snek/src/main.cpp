@@ -2,12 +2,327 @@
 #include "game_state.h"
 #include "game_logic.h"
 #include "renderer.h"
+#include "audio_manager.h"
 #include "game_types.h"
-#include <deque>
+#include "replay.h"
+#include "fixed_step_clock.h"
+#include "autopilot.h"
+#include "arena.h"
+#include "frame_profiler.h"
+#include "rewind_buffer.h"
+#include "spectator_stream.h"
+#include "input_queue.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
 
-int main() {
+// Cold-start instrumentation: reports the time from process start to the first presented frame
+static const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+static bool firstFrameShown = false;
+
+static double MillisSinceStart() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - processStart).count();
+}
+
+// Frame timing for the F3 overlay and --profile-csv
+static FrameProfiler profiler;
+static bool showProfiler = false;
+
+// When EndDrawing last polled the window's events, which stamps the key presses read this frame
+static InputQueue::Clock::time_point lastPoll = InputQueue::Clock::now();
+
+// Starts every frame (F3 toggles the profiler overlay)
+static void BeginFrame() {
+    if (IsKeyPressed(KEY_F3)) {
+        showProfiler = !showProfiler;
+        profiler.SetEnabled(showProfiler || profiler.CsvOpen());
+    }
+    profiler.BeginFrame();
+}
+
+// Ends every frame: presents it, then lets the audio manager make progress
+static void EndFrame(AudioManager& audio) {
+    if (showProfiler) {
+        ProfileScope scope(&profiler, PHASE_DRAW_PROFILER);
+        Renderer::DrawProfilerOverlay(profiler);
+    }
+    {
+        ProfileScope scope(&profiler, PHASE_PRESENT);
+        EndDrawing();
+    }
+    lastPoll = InputQueue::Clock::now();
+    if (!firstFrameShown) {
+        firstFrameShown = true;
+        TraceLog(LOG_INFO, "STARTUP: first frame %.1f ms after launch", MillisSinceStart());
+    }
+    {
+        ProfileScope scope(&profiler, PHASE_AUDIO);
+        audio.Update();
+    }
+    profiler.EndFrame();
+}
+
+// Reads every direction key pressed since the last poll, in order (IsKeyPressed
+// would merge repeated taps and lose the order of different keys)
+static void ReadMoveKeys(InputQueue& moveKeys) {
+    int key;
+    while ((key = GetKeyPressed()) != 0) {
+        switch (key) {
+            case KEY_UP: case KEY_W: moveKeys.Press({0, -1}, lastPoll); break;
+            case KEY_DOWN: case KEY_S: moveKeys.Press({0, 1}, lastPoll); break;
+            case KEY_LEFT: case KEY_A: moveKeys.Press({-1, 0}, lastPoll); break;
+            case KEY_RIGHT: case KEY_D: moveKeys.Press({1, 0}, lastPoll); break;
+            default: break;
+        }
+    }
+}
+
+// Replay player mode: re-simulates a recorded session at 1x to 1000x wall clock
+static void RunReplay(const Replay& replay, float speed, AudioManager& audio) {
+    GameState state;
+    state.profiler = &profiler;
+    ReplayPlayer player;
+    player.Start(replay, state);
+    
+    const uint32_t seekTicks = 5 * GameConstants::TICK_RATE;
+    bool playbackPaused = false;
+    FixedStepClock clock(1000 * GameConstants::TICK_RATE);
+    
+    while (!WindowShouldClose()) {
+        BeginFrame();
+        ProfileScope input(&profiler, PHASE_INPUT);
+        if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_Q)) {
+            break;
+        }
+        
+        // UP/DOWN change speed, LEFT/RIGHT seek, SPACE pauses playback
+        if (IsKeyPressed(KEY_UP) && speed < 1000.0f) {
+            speed = (speed * 2.0f > 1000.0f) ? 1000.0f : speed * 2.0f;
+        }
+        if (IsKeyPressed(KEY_DOWN) && speed > 1.0f) {
+            speed = (speed / 2.0f < 1.0f) ? 1.0f : speed / 2.0f;
+        }
+        if (IsKeyPressed(KEY_LEFT)) {
+            uint32_t tick = player.CurrentTick();
+            player.SeekTo(state, (tick > seekTicks) ? tick - seekTicks : 0);
+            clock.Reset();
+        }
+        if (IsKeyPressed(KEY_RIGHT)) {
+            player.SeekTo(state, player.CurrentTick() + seekTicks);
+            clock.Reset();
+        }
+        if (IsKeyPressed(KEY_SPACE)) {
+            playbackPaused = !playbackPaused;
+        }
+        input.End();
+        
+        // Run as many ticks as this wall-clock frame covers at the current speed
+        if (!playbackPaused && !player.Finished()) {
+            int steps = clock.Advance(GetFrameTime() * speed);
+            for (int i = 0; i < steps; i++) {
+                if (!player.Step(state)) {
+                    break;
+                }
+            }
+        }
+        
+        // Only play sounds at normal speed
+        if (speed <= 1.0f && !playbackPaused) {
+            ProfileScope scope(&profiler, PHASE_AUDIO);
+            audio.PlayEvents(state.events);
+        }
+        state.events.Clear();
+        
+        BeginDrawing();
+        {
+            ProfileScope scope(&profiler, PHASE_DRAW_GAME);
+            Renderer::DrawGame(state);
+        }
+        if (state.gameOver) {
+            ProfileScope scope(&profiler, PHASE_DRAW_GAME_OVER);
+            Renderer::DrawGameOverScreen(state);
+        }
+        {
+            ProfileScope scope(&profiler, PHASE_DRAW_REPLAY_OVERLAY);
+            Renderer::DrawReplayOverlay(player, speed, playbackPaused);
+        }
+        EndFrame(audio);
+    }
+}
+
+// Arena mode: the player against a board full of bots, at the accelerated move rate
+static void RunArena(ArenaConfig config, AudioManager& audio) {
+    Arena arena;
+    arena.Initialize(config);
+    const int movesPerSecond = GameConstants::TICK_RATE / GameConstants::MOVE_INTERVAL_ACCELERATED;
+    FixedStepClock clock(1, movesPerSecond);
+    InputQueue moveKeys;
+    
+    while (!WindowShouldClose()) {
+        BeginFrame();
+        ProfileScope input(&profiler, PHASE_INPUT);
+        if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_Q)) {
+            break;
+        }
+        
+        // Same keys as the main game (arrows or WASD), in the order pressed
+        ReadMoveKeys(moveKeys);
+        if (arena.PlayerAlive()) {
+            Direction move;
+            while (moveKeys.NextPress(move)) {
+                arena.QueuePlayerDirection(move);
+            }
+            input.End();
+            
+            int score = arena.Player().score;
+            int steps = clock.Advance(GetFrameTime());
+            ProfileScope movement(&profiler, PHASE_MOVEMENT);
+            for (int i = 0; i < steps && arena.PlayerAlive(); i++) {
+                arena.Step();
+            }
+            movement.End();
+            ProfileScope scope(&profiler, PHASE_AUDIO);
+            if (arena.Player().score > score) {
+                audio.Play(SOUND_APPLE);
+            }
+            if (!arena.PlayerAlive()) {
+                audio.Play(SOUND_GAME_OVER);
+            }
+        } else {
+            moveKeys.Clear();
+            if (IsKeyPressed(KEY_R) || IsKeyPressed(KEY_SPACE)) {
+                config.seed++;
+                arena.Initialize(config);
+                clock.Reset();
+            }
+        }
+        
+        input.End();
+        
+        BeginDrawing();
+        {
+            ProfileScope scope(&profiler, PHASE_DRAW_ARENA);
+            Renderer::DrawArena(arena);
+        }
+        if (!arena.PlayerAlive()) {
+            ProfileScope scope(&profiler, PHASE_DRAW_ARENA_GAME_OVER);
+            Renderer::DrawArenaGameOverScreen(arena);
+        }
+        EndFrame(audio);
+    }
+}
+
+// Spectator mode: mirrors a game another process publishes with --spectate
+static void RunSpectator(const std::string& name, AudioManager& audio) {
+    SpectatorReader reader;
+    GameState view;
+    
+    while (!WindowShouldClose()) {
+        BeginFrame();
+        ProfileScope input(&profiler, PHASE_INPUT);
+        if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_Q)) {
+            break;
+        }
+        input.End();
+        
+        // Follow the game, and look for the next one once it closes
+        if (reader.WriterClosed()) {
+            reader.Detach();
+        }
+        if (!reader.IsAttached()) {
+            reader.Attach(name);
+        }
+        reader.Poll(view);
+        
+        BeginDrawing();
+        if (reader.Synced()) {
+            {
+                ProfileScope scope(&profiler, PHASE_DRAW_GAME);
+                Renderer::DrawGame(view);
+            }
+            if (view.isUserPaused && !view.gameOver) {
+                ProfileScope scope(&profiler, PHASE_DRAW_PAUSE);
+                Renderer::DrawPauseScreen(view);
+            }
+            if (view.isResuming && !view.gameOver) {
+                ProfileScope scope(&profiler, PHASE_DRAW_COUNTDOWN);
+                Renderer::DrawResumeCountdown(view);
+            }
+            if (view.gameOver) {
+                ProfileScope scope(&profiler, PHASE_DRAW_GAME_OVER);
+                Renderer::DrawGameOverScreen(view);
+            }
+        } else {
+            ClearBackground(BLACK);
+        }
+        {
+            ProfileScope scope(&profiler, PHASE_DRAW_SPECTATOR_OVERLAY);
+            Renderer::DrawSpectatorOverlay(reader.Synced(), (int)reader.Overruns());
+        }
+        EndFrame(audio);
+    }
+}
+
+int main(int argc, char** argv) {
+    // Command line: --record <file> saves each finished game, --replay <file> [--speed <n>] plays one back,
+    // --board <cols>x<rows> picks the board size (larger than the screen scrolls with the head),
+    // --autopilot [microseconds] lets the bot play (TAB toggles it in game),
+    // --arena <snakes> plays against that many bots (on a 256x256 board unless --board is given),
+    // --profile-csv <file> writes every frame's phase timings to a CSV file (F3 shows them on screen),
+    // --spectate [name] publishes the game for spectators, --watch [name] is one
+    std::string recordPath;
+    std::string replayPath;
+    float replaySpeed = 1.0f;
+    int boardWidth = GameConstants::GRID_WIDTH;
+    int boardHeight = GameConstants::GRID_HEIGHT;
+    bool autopilotOn = false;
+    int autopilotBudget = 500;
+    bool boardGiven = false;
+    int arenaSnakes = 0;
+    std::string profilePath;
+    std::string spectateName;
+    std::string watchName;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--board") == 0 && i + 1 < argc) {
+            char* end = nullptr;
+            boardWidth = (int)std::strtol(argv[++i], &end, 10);
+            boardHeight = (*end == 'x') ? (int)std::strtol(end + 1, nullptr, 10) : boardWidth;
+            boardGiven = true;
+        } else if (std::strcmp(argv[i], "--arena") == 0 && i + 1 < argc) {
+            arenaSnakes = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--autopilot") == 0) {
+            autopilotOn = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                autopilotBudget = std::atoi(argv[++i]);
+            }
+        } else if (std::strcmp(argv[i], "--spectate") == 0 || std::strcmp(argv[i], "--watch") == 0) {
+            std::string& name = (argv[i][2] == 's') ? spectateName : watchName;
+            name = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "live";
+        } else if (std::strcmp(argv[i], "--profile-csv") == 0 && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            replaySpeed = (float)std::atof(argv[++i]);
+            if (replaySpeed < 1.0f) replaySpeed = 1.0f;
+            if (replaySpeed > 1000.0f) replaySpeed = 1000.0f;
+        }
+    }
+    
+    Replay replay;
+    if (!replayPath.empty() && !replay.LoadFromFile(replayPath)) {
+        TraceLog(LOG_ERROR, "Could not load replay %s", replayPath.c_str());
+        return 1;
+    }
+    
     // Initialize window first (required for web)
     InitWindow(GameConstants::SCREEN_WIDTH, GameConstants::SCREEN_HEIGHT, "Snake Game");
+    TraceLog(LOG_INFO, "STARTUP: window ready %.1f ms after launch", MillisSinceStart());
     
     #ifdef PLATFORM_WEB
     // GL context initialization is handled by gl_init_post.js
@@ -15,16 +330,87 @@ int main() {
     PollInputEvents();
     #endif
     
-    // Initialize audio after window
-    InitAudioDevice();
     SetTargetFPS(60);
     
-    // Initialize game state
+    if (!profilePath.empty()) {
+        if (profiler.OpenCsv(profilePath)) {
+            profiler.SetEnabled(true);
+        } else {
+            TraceLog(LOG_WARNING, "Could not write frame timings to %s", profilePath.c_str());
+        }
+    }
+    
+    // Sounds decode in the background; the audio device opens after the first frame
+    AudioManager audio;
+    audio.StartLoading();
+    
+    if (!replayPath.empty() || arenaSnakes > 0 || !watchName.empty()) {
+        if (!replayPath.empty()) {
+            RunReplay(replay, replaySpeed, audio);
+        } else if (!watchName.empty()) {
+            RunSpectator(watchName, audio);
+        } else {
+            ArenaConfig config;
+            config.snakes = arenaSnakes;
+            if (boardGiven) {
+                config.width = boardWidth;
+                config.height = boardHeight;
+            }
+            config.seed = (uint64_t)std::time(nullptr);
+            RunArena(config, audio);
+        }
+        profiler.CloseCsv();
+        Renderer::Unload();
+        audio.Unload();
+        CloseWindow();
+        return 0;
+    }
+    
+    // Every game gets a fresh seed so it can be recorded and replayed
+    Rng seedSource((uint64_t)std::time(nullptr));
     GameState state;
-    state.Initialize();
+    state.profiler = &profiler;
+    state.SetBoardSize(boardWidth, boardHeight);
+    state.Initialize(seedSource.Next());
+    ReplayRecorder recorder;
+    FixedStepClock clock;
+    Autopilot autopilot(autopilotBudget);
+    RewindBuffer rewind(GameConstants::REWIND_SECONDS);
+    InputQueue moveKeys;
+    SpectatorWriter spectators;
+    if (!spectateName.empty() && !spectators.Open(spectateName, state.boardWidth, state.boardHeight)) {
+        TraceLog(LOG_WARNING, "Could not publish spectator stream %s", spectateName.c_str());
+    }
+    
+    auto startGame = [&]() {
+        state.Reset(seedSource.Next());
+        rewind.Attach(state);
+        moveKeys.Clear();
+        clock.Reset();
+        if (!recordPath.empty()) {
+            recorder.Begin(state);
+        }
+    };
+    auto queuePresses = [&]() {
+        Direction move;
+        while (moveKeys.QueueNext(state, move)) {
+            recorder.RecordDirection(state.tick, move);
+        }
+    };
+    auto finishRecording = [&]() {
+        if (recorder.IsRecording()) {
+            recorder.End(state.tick);
+            if (!recorder.SaveToFile(recordPath)) {
+                TraceLog(LOG_WARNING, "Could not write replay %s", recordPath.c_str());
+            }
+        }
+    };
     
     // Main game loop
     while (!WindowShouldClose()) {
+        BeginFrame();
+        ProfileScope input(&profiler, PHASE_INPUT);
+        
         // Handle ESC (always exits)
         if (IsKeyPressed(KEY_ESCAPE)) {
             break;
@@ -39,174 +425,164 @@ int main() {
                 state.selectedModeIndex = 1;
             }
             if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_ENTER)) {
-                state.gameMode = (state.selectedModeIndex == 0) ? MODE_REGULAR : MODE_ACCELERATED;
-                state.showModeSelection = false;
-                state.showInstructions = true;
-                
-                // Initialize apples based on game mode
-                state.apples.clear();
-                if (state.gameMode == MODE_ACCELERATED) {
-                    for (int i = 0; i < 3; i++) {
-                        state.SpawnApple(0.0f);
-                    }
-                } else {
-                    state.SpawnApple(0.0f);
-                }
+                state.StartMode((state.selectedModeIndex == 0) ? MODE_REGULAR : MODE_ACCELERATED);
             }
+            input.End();
             
             BeginDrawing();
-            Renderer::DrawModeSelectionScreen(state);
-            EndDrawing();
+            {
+                ProfileScope scope(&profiler, PHASE_DRAW_MODE_SELECTION);
+                Renderer::DrawModeSelectionScreen(state);
+            }
+            EndFrame(audio);
             continue;
         }
         
         // Handle instructions screen
         if (state.showInstructions) {
             if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_ENTER)) {
-                state.showInstructions = false;
-                state.gameTime = 0.0f;
+                startGame();
             }
+            input.End();
             
             BeginDrawing();
-            Renderer::DrawInstructionsScreen();
-            EndDrawing();
+            {
+                ProfileScope scope(&profiler, PHASE_DRAW_INSTRUCTIONS);
+                Renderer::DrawInstructionsScreen();
+            }
+            EndFrame(audio);
             continue;
         }
         
-        float deltaTime = GetFrameTime();
-        
-        // Update game time
-        if (!state.isUserPaused && !state.isResuming) {
-            state.gameTime += deltaTime;
-        }
-        
-        // Update status effects and apple despawn
-        if (!state.isUserPaused && !state.isResuming) {
-            state.UpdateStatusEffects(deltaTime);
-        }
-        state.UpdateAppleDespawn(deltaTime);
-        
         // Handle input
         if (IsKeyPressed(KEY_Q)) {
             if (!state.gameOver) {
-                state.gameOver = true;
+                GameLogic::Quit(state);
+                recorder.RecordQuit(state.tick);
             } else {
                 break;
             }
         }
         
+        if (IsKeyPressed(KEY_TAB)) {
+            autopilotOn = !autopilotOn;
+        }
+        
         if (!state.gameOver && IsKeyPressed(KEY_P)) {
-            if (state.isUserPaused) {
-                state.isResuming = true;
-                state.resumeDelayTimer = GameConstants::RESUME_DELAY_DURATION;
-                state.pauseSoundTimer = 1.0f;
-                state.isUserPaused = false;
-            } else if (!state.isResuming) {
-                state.isUserPaused = true;
+            if (GameLogic::TogglePause(state)) {
+                recorder.RecordPauseToggle(state.tick);
             }
         }
         
         // Handle game over restart and menu
         if (state.gameOver) {
             if (IsKeyPressed(KEY_R) || IsKeyPressed(KEY_SPACE)) {
-                state.Reset();
+                startGame();
             }
             if (IsKeyPressed(KEY_M)) {
                 // Return to mode selection menu
-                state.gameOver = false;
-                state.showModeSelection = true;
-                state.showInstructions = false;
-                state.score = 0;
-                // Reset game state but keep high scores
-                state.snake.clear();
-                state.apples.clear();
-                state.dx = 0;
-                state.dy = 0;
-                state.directionQueue.clear();
-                state.moveTimer = 0.0f;
-                state.gameTime = 0.0f;
-                state.canIntersectSelf = false;
-                state.immunityTimer = 0.0f;
-                state.canPassWalls = false;
-                state.wallImmunityTimer = 0.0f;
-                state.cannotEatApples = false;
-                state.cannotEatTimer = 0.0f;
-                state.isPaused = false;
-                state.pauseTimer = 0.0f;
-                state.isUserPaused = false;
-                state.isResuming = false;
-                state.resumeDelayTimer = 0.0f;
-                state.poisonSoundTimer = 0.0f;
-                state.pauseSoundTimer = 0.0f;
-                state.gameOverSoundPlayed = false;
-            }
-        }
-        
-        // Handle movement input
-        if (!state.gameOver && !state.isUserPaused && !state.isResuming) {
-            if (IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_W)) {
-                Direction newDir = {0, -1};
-                if (((state.dx == 0 && state.dy == 0) || state.dy != 1) && 
-                    (state.directionQueue.empty() || 
-                     state.directionQueue.back().dx != newDir.dx || 
-                     state.directionQueue.back().dy != newDir.dy)) {
-                    state.directionQueue.push_back(newDir);
-                }
+                state.ReturnToMenu();
             }
-            if (IsKeyPressed(KEY_DOWN) || IsKeyPressed(KEY_S)) {
-                Direction newDir = {0, 1};
-                if (((state.dx == 0 && state.dy == 0) || state.dy != -1) && 
-                    (state.directionQueue.empty() || 
-                     state.directionQueue.back().dx != newDir.dx || 
-                     state.directionQueue.back().dy != newDir.dy)) {
-                    state.directionQueue.push_back(newDir);
-                }
+        }
+        
+        // Handle movement input (queued with the ticks below)
+        ReadMoveKeys(moveKeys);
+        
+        // Hold BACKSPACE to scrub back, or press T after a game over to retry
+        // from a few seconds earlier. A replay can't follow a rewind, so the
+        // recording ends (and is saved) at the first one.
+        bool rewinding = IsKeyDown(KEY_BACKSPACE) && rewind.Available() > 0;
+        bool retry = state.gameOver && IsKeyPressed(KEY_T) && rewind.Available() > 0;
+        if (rewinding || retry) {
+            finishRecording();
+            rewind.Rewind(state, rewinding ? GameConstants::REWIND_SPEED
+                                           : GameConstants::RETRY_SECONDS * GameConstants::TICK_RATE);
+            spectators.Publish(state);
+            moveKeys.Clear();
+            clock.Reset();
+        }
+        input.End();
+        
+        // Run however many fixed ticks this frame covers and play the sounds they produced.
+        // The keys were polled after every tick a slow frame catches up on, so
+        // they go in before the last one (or before the next frame's first).
+        // The autopilot queues its moves like keypresses, so they are recorded too
+        int steps = rewinding ? 0 : clock.Advance(GetFrameTime());
+        if (steps == 0) {
+            queuePresses();
+        }
+        for (int i = 0; i < steps; i++) {
+            if (i == steps - 1) {
+                queuePresses();
             }
-            if (IsKeyPressed(KEY_LEFT) || IsKeyPressed(KEY_A)) {
-                Direction newDir = {-1, 0};
-                if (((state.dx == 0 && state.dy == 0) || state.dx != 1) && 
-                    (state.directionQueue.empty() || 
-                     state.directionQueue.back().dx != newDir.dx || 
-                     state.directionQueue.back().dy != newDir.dy)) {
-                    state.directionQueue.push_back(newDir);
+            if (autopilotOn) {
+                ProfileScope scope(&profiler, PHASE_AUTOPILOT);
+                Direction move;
+                if (autopilot.ChooseMove(state, move) && GameLogic::QueueDirection(state, move)) {
+                    recorder.RecordDirection(state.tick, move);
+                    moveKeys.QueuedUntimed();
                 }
             }
-            if (IsKeyPressed(KEY_RIGHT) || IsKeyPressed(KEY_D)) {
-                Direction newDir = {1, 0};
-                if (((state.dx == 0 && state.dy == 0) || state.dx != -1) && 
-                    (state.directionQueue.empty() || 
-                     state.directionQueue.back().dx != newDir.dx || 
-                     state.directionQueue.back().dy != newDir.dy)) {
-                    state.directionQueue.push_back(newDir);
-                }
+            moveKeys.BeforeStep(state);
+            GameLogic::Step(state);
+            float latency;
+            if (moveKeys.AfterStep(state, latency)) {
+                profiler.AddInputLatency(latency);
+            }
+            spectators.Publish(state);
+            // Frozen ticks (paused or over) aren't worth rewinding through
+            if (!state.gameOver && !state.isUserPaused) {
+                rewind.Capture(state);
             }
         }
-        
-        // Process game logic
-        GameLogic::ProcessMovement(state, deltaTime);
+        {
+            ProfileScope scope(&profiler, PHASE_AUDIO);
+            audio.PlayEvents(state.events);
+        }
+        state.events.Clear();
+        if (state.gameOver) {
+            finishRecording();
+        }
         
         // Draw everything
         BeginDrawing();
-        Renderer::DrawGame(state);
+        {
+            ProfileScope scope(&profiler, PHASE_DRAW_GAME);
+            Renderer::DrawGame(state);
+        }
+        
+        if (rewinding) {
+            ProfileScope scope(&profiler, PHASE_DRAW_REWIND_OVERLAY);
+            Renderer::DrawRewindOverlay(rewind.Available());
+        } else if (autopilotOn) {
+            ProfileScope scope(&profiler, PHASE_DRAW_AUTOPILOT_BADGE);
+            Renderer::DrawAutopilotBadge(autopilot.GetStats());
+        }
         
         if (state.isUserPaused && !state.gameOver) {
+            ProfileScope scope(&profiler, PHASE_DRAW_PAUSE);
             Renderer::DrawPauseScreen(state);
         }
         
         if (state.isResuming && !state.gameOver) {
+            ProfileScope scope(&profiler, PHASE_DRAW_COUNTDOWN);
             Renderer::DrawResumeCountdown(state);
         }
         
         if (state.gameOver) {
-            Renderer::DrawGameOverScreen(state);
+            ProfileScope scope(&profiler, PHASE_DRAW_GAME_OVER);
+            Renderer::DrawGameOverScreen(state, rewind.Available() > 0);
         }
         
-        EndDrawing();
+        EndFrame(audio);
     }
     
     // Cleanup
-    state.Cleanup();
-    CloseAudioDevice();
+    finishRecording();
+    spectators.Close();
+    profiler.CloseCsv();
+    Renderer::Unload();
+    audio.Unload();
     CloseWindow();
     
     return 0;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "free_cells.h"
+#include "game_types.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-cell occupancy for the board: how many snake segments cover each cell
+// (segments can overlap while growing or under Resistance) and which apple,
+// if any, sits there. Lets collision and spawn checks run in constant time.
+// Also keeps an index of the free cells (FreeCells) so a uniformly random
+// free cell can be picked in O(log cells) for apple spawns and teleports.
+class OccupancyGrid {
+public:
+    static constexpr int NO_APPLE = -1;
+    
+    void Resize(int width, int height) {
+        width_ = width;
+        height_ = height;
+        snakeCount_.resize((size_t)width * height);
+        appleIndex_.resize((size_t)width * height);
+        freeBits_.resize(FreeCells::Words(width * height));
+        freeCounts_.resize(FreeCells::Words(width * height));
+        Clear();
+    }
+    
+    void Clear() {
+        std::fill(snakeCount_.begin(), snakeCount_.end(), 0);
+        std::fill(appleIndex_.begin(), appleIndex_.end(), NO_APPLE);
+        FreeCells::Fill(freeBits_.data(), freeCounts_.data(), (int)snakeCount_.size());
+        freeCount_ = (int)snakeCount_.size();
+    }
+    
+    int Width() const { return width_; }
+    int Height() const { return height_; }
+    
+    // Snake segments
+    void AddSnake(Position pos) {
+        int i = Index(pos.col, pos.row);
+        if (snakeCount_[i]++ == 0) {
+            MarkTaken(i);
+        }
+    }
+    void RemoveSnake(Position pos) {
+        int i = Index(pos.col, pos.row);
+        if (--snakeCount_[i] == 0 && appleIndex_[i] == NO_APPLE) {
+            MarkFree(i);
+        }
+    }
+    bool HasSnake(int col, int row) const { return snakeCount_[Index(col, row)] != 0; }
+    
+    // Apples (index into GameState::apples)
+    void SetApple(int col, int row, int appleIndex) {
+        int i = Index(col, row);
+        appleIndex_[i] = (int16_t)appleIndex;
+        MarkTaken(i);
+    }
+    void ClearApple(int col, int row) {
+        int i = Index(col, row);
+        appleIndex_[i] = NO_APPLE;
+        if (snakeCount_[i] == 0) {
+            MarkFree(i);
+        }
+    }
+    int AppleAt(int col, int row) const { return appleIndex_[Index(col, row)]; }
+    
+    bool IsFree(int col, int row) const { return FreeCells::Has(freeBits_.data(), Index(col, row)); }
+    
+    // Free cells, in row-major order; pick FreeCell(random index) for a uniform choice
+    int FreeCount() const { return freeCount_; }
+    Position FreeCell(int index) const {
+        int i = FreeCells::Find(freeBits_.data(), freeCounts_.data(), (int)freeBits_.size(), index);
+        return {i % width_, i / width_};
+    }
+
+private:
+    int Index(int col, int row) const { return row * width_ + col; }
+    
+    void MarkFree(int i) {
+        if (FreeCells::Add(freeBits_.data(), freeCounts_.data(), (int)freeBits_.size(), i)) {
+            freeCount_++;
+        }
+    }
+    void MarkTaken(int i) {
+        if (FreeCells::Remove(freeBits_.data(), freeCounts_.data(), (int)freeBits_.size(), i)) {
+            freeCount_--;
+        }
+    }
+    
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<uint16_t> snakeCount_;
+    std::vector<int16_t> appleIndex_;
+    std::vector<uint64_t> freeBits_;
+    std::vector<uint32_t> freeCounts_;
+    int freeCount_ = 0;
+};
@@ -1,27 +1,220 @@
 #include "renderer.h"
 #include "game_types.h"
-#include "raylib.h"
-#include <string>
-#include <cmath>
+#include "game_colors.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    // Window onto the board: the world cell drawn at the top-left of the board
+    // area. World cells run from -1 to the board size, -1 and size being the border.
+    struct BoardView {
+        int col;
+        int row;
+    };
+    
+    // Boards that fit are centered (the default board fills the view exactly);
+    // larger ones follow the head, clamped so the view never leaves the border
+    int ViewOrigin(int head, int boardCells, int viewCells) {
+        if (boardCells + 2 <= viewCells) {
+            return -1 - (viewCells - (boardCells + 2)) / 2;
+        }
+        return std::clamp(head - viewCells / 2, -1, boardCells + 1 - viewCells);
+    }
+    
+    BoardView MakeView(Position focus, int width, int height) {
+        return {ViewOrigin(focus.col, width, GameConstants::TOTAL_GRID_WIDTH),
+                ViewOrigin(focus.row, height, GameConstants::TOTAL_GRID_HEIGHT)};
+    }
+    
+    bool InView(const BoardView& view, int col, int row) {
+        return col >= view.col && col < view.col + GameConstants::TOTAL_GRID_WIDTH &&
+               row >= view.row && row < view.row + GameConstants::TOTAL_GRID_HEIGHT;
+    }
+    
+    int ScreenX(const BoardView& view, int col) {
+        return (col - view.col) * GameConstants::CELL_SIZE;
+    }
+    
+    int ScreenY(const BoardView& view, int row) {
+        return GameConstants::BOARD_START_Y + (row - view.row) * GameConstants::CELL_SIZE;
+    }
+    
+    void DrawCell(const BoardView& view, Position pos, Color color) {
+        DrawRectangle(ScreenX(view, pos.col), ScreenY(view, pos.row),
+                      GameConstants::CELL_SIZE, GameConstants::CELL_SIZE, color);
+    }
+    
+    // Fill the world cells [col0, col1) x [row0, row1), clipped to the view, with one rectangle
+    void FillCells(const BoardView& view, int col0, int row0, int col1, int row1, Color color) {
+        col0 = std::max(col0, view.col);
+        row0 = std::max(row0, view.row);
+        col1 = std::min(col1, view.col + GameConstants::TOTAL_GRID_WIDTH);
+        row1 = std::min(row1, view.row + GameConstants::TOTAL_GRID_HEIGHT);
+        if (col0 < col1 && row0 < row1) {
+            DrawRectangle(ScreenX(view, col0), ScreenY(view, row0),
+                          (col1 - col0) * GameConstants::CELL_SIZE, (row1 - row0) * GameConstants::CELL_SIZE, color);
+        }
+    }
+    
+    // Pre-rendered checkerboard one cell wider than the view, so it can be
+    // shifted a cell to line up with the board's parity wherever the view is
+    const int CHECKER_COLS = GameConstants::TOTAL_GRID_WIDTH + 1;
+    const int CHECKER_ROWS = GameConstants::TOTAL_GRID_HEIGHT;
+    RenderTexture2D checkerLayer = {};
+    
+    void RenderCheckerLayer() {
+        int cellSize = GameConstants::CELL_SIZE;
+        BeginTextureMode(checkerLayer);
+        ClearBackground(BLACK);
+        
+        // Black cells are already the clear color
+        for (int row = 0; row < CHECKER_ROWS; row++) {
+            for (int col = 0; col < CHECKER_COLS; col++) {
+                if ((row + col) % 2 != 0) {
+                    DrawRectangle(col * cellSize, row * cellSize, cellSize, cellSize, GameConstants::GRAY_COLOR);
+                }
+            }
+        }
+        
+        EndTextureMode();
+    }
+    
+    // Part of the playing field inside the view, in world cells [col0, col1) x [row0, row1)
+    struct VisibleCells {
+        int col0;
+        int row0;
+        int col1;
+        int row1;
+    };
+    
+    // Border and checkerboard of a width x height board
+    VisibleCells DrawField(const BoardView& view, int width, int height) {
+        // Border strips, each a single rectangle
+        FillCells(view, -1, -1, width + 1, 0, WHITE);
+        FillCells(view, -1, height, width + 1, height + 1, WHITE);
+        FillCells(view, -1, 0, 0, height, WHITE);
+        FillCells(view, width, 0, width + 1, height, WHITE);
+        
+        // Visible part of the playing field
+        int col0 = std::max(0, view.col);
+        int row0 = std::max(0, view.row);
+        int col1 = std::min(width, view.col + GameConstants::TOTAL_GRID_WIDTH);
+        int row1 = std::min(height, view.row + GameConstants::TOTAL_GRID_HEIGHT);
+        
+        // Checkerboard: blit the cached layer, shifted to match the parity of the
+        // first visible cell and clipped to the visible field
+        if (checkerLayer.id == 0) {
+            checkerLayer = LoadRenderTexture(CHECKER_COLS * GameConstants::CELL_SIZE, CHECKER_ROWS * GameConstants::CELL_SIZE);
+            RenderCheckerLayer();
+        }
+        int layerCol = col0 - ((col0 + row0) & 1);
+        BeginScissorMode(ScreenX(view, col0), ScreenY(view, row0),
+                         (col1 - col0) * GameConstants::CELL_SIZE, (row1 - row0) * GameConstants::CELL_SIZE);
+        // Render textures are stored bottom-up, so flip vertically when drawing
+        Rectangle source = {0.0f, 0.0f, (float)checkerLayer.texture.width, -(float)checkerLayer.texture.height};
+        DrawTextureRec(checkerLayer.texture, source, {(float)ScreenX(view, layerCol), (float)ScreenY(view, row0)}, WHITE);
+        EndScissorMode();
+        return {col0, row0, col1, row1};
+    }
+    
+    // Text that never changes, measured once on first use
+    struct StaticText {
+        const char* text;
+        int fontSize;
+        int width;
+        
+        StaticText(const char* text, int fontSize)
+            : text(text), fontSize(fontSize), width(MeasureText(text, fontSize)) {}
+    };
+    
+    // Text built from a printf format and up to two ints; the string and its
+    // width are only rebuilt when one of the values changes
+    struct CachedText {
+        const char* format;
+        int fontSize;
+        int width = 0;
+        char text[48] = {};
+        int valueA = 0;
+        int valueB = 0;
+        bool valid = false;
+        
+        CachedText(const char* format, int fontSize) : format(format), fontSize(fontSize) {}
+        
+        const CachedText& Set(int a, int b = 0) {
+            if (!valid || a != valueA || b != valueB) {
+                std::snprintf(text, sizeof(text), format, a, b);
+                width = MeasureText(text, fontSize);
+                valueA = a;
+                valueB = b;
+                valid = true;
+            }
+            return *this;
+        }
+    };
+    
+    int CenteredX(int width) {
+        return (GameConstants::SCREEN_WIDTH - width) / 2;
+    }
+}
+
+void Renderer::DrawBoard(const GameState& state) {
+    Position head = state.snake.empty() ? Position{0, 0} : state.snake.front();
+    BoardView view = MakeView(head, state.boardWidth, state.boardHeight);
+    VisibleCells visible = DrawField(view, state.boardWidth, state.boardHeight);
+    
+    // Apples (there are only a handful, so just skip the off-screen ones)
+    for (const auto& apple : state.apples) {
+        if (!InView(view, apple.col, apple.row)) {
+            continue;
+        }
+        Color foodColor;
+        if (apple.type == POMME_SUPREME) {
+            foodColor = GameConstants::ENCHANTED_GOLD_COLOR;
+        } else if (apple.type == POMME_PLUS) {
+            foodColor = GameConstants::GOLD_COLOR;
+        } else if (apple.type == POISONOUS) {
+            foodColor = GameConstants::POISON_COLOR;
+        } else if (apple.type == TELEPORT) {
+            foodColor = GameConstants::PURPLE_COLOR;
+        } else {
+            foodColor = RED;
+        }
+        DrawCell(view, {apple.col, apple.row}, foodColor);
+    }
+    
+    // Snake: look up the visible cells in the occupancy grid rather than
+    // walking the body, so the cost doesn't grow with the snake's length
+    for (int row = visible.row0; row < visible.row1; row++) {
+        for (int col = visible.col0; col < visible.col1; col++) {
+            if (state.grid.HasSnake(col, row)) {
+                DrawCell(view, {col, row}, GameConstants::SNAKE_COLOR);
+            }
+        }
+    }
+    if (!state.snake.empty()) {
+        DrawCell(view, state.snake.front(), GameConstants::SNAKE_HEAD_COLOR);
+    }
+}
+
+void Renderer::Unload() {
+    if (checkerLayer.id != 0) {
+        UnloadRenderTexture(checkerLayer);
+        checkerLayer = {};
+    }
+}
 
 void Renderer::DrawModeSelectionScreen(const GameState& state) {
     ClearBackground(BLACK);
     
     // Title
-    const int titleFontSize = 60;
-    std::string titleText = "SNAKE GAME";
-    int titleWidth = MeasureText(titleText.c_str(), titleFontSize);
-    int titleX = (GameConstants::SCREEN_WIDTH - titleWidth) / 2;
+    static const StaticText title("SNAKE GAME", 60);
     int titleY = 150;
-    DrawText(titleText.c_str(), titleX, titleY, titleFontSize, WHITE);
+    DrawText(title.text, CenteredX(title.width), titleY, title.fontSize, WHITE);
     
     // Subtitle
-    const int subtitleFontSize = 32;
-    std::string subtitleText = "Select Game Mode";
-    int subtitleWidth = MeasureText(subtitleText.c_str(), subtitleFontSize);
-    int subtitleX = (GameConstants::SCREEN_WIDTH - subtitleWidth) / 2;
+    static const StaticText subtitle("Select Game Mode", 32);
     int subtitleY = titleY + 80;
-    DrawText(subtitleText.c_str(), subtitleX, subtitleY, subtitleFontSize, YELLOW);
+    DrawText(subtitle.text, CenteredX(subtitle.width), subtitleY, subtitle.fontSize, YELLOW);
     
     // Mode options
     const int modeFontSize = 36;
@@ -30,20 +223,16 @@ void Renderer::DrawModeSelectionScreen(const GameState& state) {
     int modeX = GameConstants::SCREEN_WIDTH / 2;
     
     // Regular mode
+    static const StaticText regular("Regular", modeFontSize);
     Color regularColor = (state.selectedModeIndex == 0) ? GREEN : LIGHTGRAY;
-    std::string regularText = "Regular";
-    int regularTextWidth = MeasureText(regularText.c_str(), modeFontSize);
-    int regularX = modeX - regularTextWidth / 2;
     int regularY = modeStartY;
-    DrawText(regularText.c_str(), regularX, regularY, modeFontSize, regularColor);
+    DrawText(regular.text, modeX - regular.width / 2, regularY, modeFontSize, regularColor);
     
     // Accelerated mode
+    static const StaticText accelerated("Accelerated", modeFontSize);
     Color acceleratedColor = (state.selectedModeIndex == 1) ? GREEN : LIGHTGRAY;
-    std::string acceleratedText = "Accelerated";
-    int acceleratedTextWidth = MeasureText(acceleratedText.c_str(), modeFontSize);
-    int acceleratedX = modeX - acceleratedTextWidth / 2;
     int acceleratedY = modeStartY + modeSpacing;
-    DrawText(acceleratedText.c_str(), acceleratedX, acceleratedY, modeFontSize, acceleratedColor);
+    DrawText(accelerated.text, modeX - accelerated.width / 2, acceleratedY, modeFontSize, acceleratedColor);
     
     // Selection indicator
     const int arrowSize = 20;
@@ -52,32 +241,24 @@ void Renderer::DrawModeSelectionScreen(const GameState& state) {
     DrawText(">", arrowX, arrowY, arrowSize, GREEN);
     
     // Instructions
-    const int instructionFontSize = 20;
-    std::string instructionText = "Use UP/DOWN or W/S to select, SPACE or ENTER to confirm";
-    int instructionWidth = MeasureText(instructionText.c_str(), instructionFontSize);
-    int instructionX = (GameConstants::SCREEN_WIDTH - instructionWidth) / 2;
+    static const StaticText instruction("Use UP/DOWN or W/S to select, SPACE or ENTER to confirm", 20);
     int instructionY = acceleratedY + modeSpacing + 40;
-    DrawText(instructionText.c_str(), instructionX, instructionY, instructionFontSize, LIGHTGRAY);
+    DrawText(instruction.text, CenteredX(instruction.width), instructionY, instruction.fontSize, LIGHTGRAY);
 }
 
 void Renderer::DrawInstructionsScreen() {
     ClearBackground(BLACK);
     
     // Title
-    const int titleFontSize = 50;
-    std::string titleText = "SNAKE GAME";
-    int titleWidth = MeasureText(titleText.c_str(), titleFontSize);
-    int titleX = (GameConstants::SCREEN_WIDTH - titleWidth) / 2;
+    static const StaticText title("SNAKE GAME", 50);
     int titleY = 40;
-    DrawText(titleText.c_str(), titleX, titleY, titleFontSize, WHITE);
+    DrawText(title.text, CenteredX(title.width), titleY, title.fontSize, WHITE);
     
     // Instructions header
     const int headerFontSize = 32;
-    std::string headerText = "APPLE TYPES";
-    int headerWidth = MeasureText(headerText.c_str(), headerFontSize);
-    int headerX = (GameConstants::SCREEN_WIDTH - headerWidth) / 2;
+    static const StaticText header("APPLE TYPES", headerFontSize);
     int headerY = titleY + 70;
-    DrawText(headerText.c_str(), headerX, headerY, headerFontSize, YELLOW);
+    DrawText(header.text, CenteredX(header.width), headerY, headerFontSize, YELLOW);
     
     // Apple type instructions
     const int textFontSize = 20;
@@ -88,47 +269,36 @@ void Renderer::DrawInstructionsScreen() {
     
     // Regular Apple
     DrawRectangle(leftMargin - 35, currentY - 2, 25, 25, RED);
-    std::string regularText = "Regular Apple (Red) - 82%: Score +1, Grow +2 units";
-    DrawText(regularText.c_str(), leftMargin, currentY, textFontSize, WHITE);
+    DrawText("Regular Apple (Red) - 82%: Score +1, Grow +2 units", leftMargin, currentY, textFontSize, WHITE);
     currentY += lineHeight;
     
     // Poisonous Apple
     DrawRectangle(leftMargin - 35, currentY - 2, 25, 25, GameConstants::POISON_COLOR);
-    std::string poisonText = "Poisonous Apple (Brown) - 10%: Reverses direction, 10s debuff";
-    DrawText(poisonText.c_str(), leftMargin, currentY, textFontSize, WHITE);
-    std::string poisonSubText = "  Cannot eat regular/purple apples during debuff";
-    DrawText(poisonSubText.c_str(), leftMargin + 10, currentY + lineHeight - 5, textFontSize - 2, LIGHTGRAY);
+    DrawText("Poisonous Apple (Brown) - 10%: Reverses direction, 10s debuff", leftMargin, currentY, textFontSize, WHITE);
+    DrawText("  Cannot eat regular/purple apples during debuff", leftMargin + 10, currentY + lineHeight - 5, textFontSize - 2, LIGHTGRAY);
     currentY += lineHeight * 2;
     
     // Pomme Plus
     DrawRectangle(leftMargin - 35, currentY - 2, 25, 25, GameConstants::GOLD_COLOR);
-    std::string pommePlusText = "Pomme Plus (Orange) - 4%: Score +2, Resistance 10s";
-    DrawText(pommePlusText.c_str(), leftMargin, currentY, textFontSize, WHITE);
-    std::string pommePlusSubText = "  Can pass through own body, works when poisoned";
-    DrawText(pommePlusSubText.c_str(), leftMargin + 10, currentY + lineHeight - 5, textFontSize - 2, LIGHTGRAY);
+    DrawText("Pomme Plus (Orange) - 4%: Score +2, Resistance 10s", leftMargin, currentY, textFontSize, WHITE);
+    DrawText("  Can pass through own body, works when poisoned", leftMargin + 10, currentY + lineHeight - 5, textFontSize - 2, LIGHTGRAY);
     currentY += lineHeight * 2;
     
     // Pomme Supreme
     DrawRectangle(leftMargin - 35, currentY - 2, 25, 25, GameConstants::ENCHANTED_GOLD_COLOR);
-    std::string pommeText = "Pomme Supreme (Yellow) - 1%: Score +2, Resistance II 10s";
-    DrawText(pommeText.c_str(), leftMargin, currentY, textFontSize, WHITE);
-    std::string pommeSubText = "  Pass through body + walls, works when poisoned";
-    DrawText(pommeSubText.c_str(), leftMargin + 10, currentY + lineHeight - 5, textFontSize - 2, LIGHTGRAY);
+    DrawText("Pomme Supreme (Yellow) - 1%: Score +2, Resistance II 10s", leftMargin, currentY, textFontSize, WHITE);
+    DrawText("  Pass through body + walls, works when poisoned", leftMargin + 10, currentY + lineHeight - 5, textFontSize - 2, LIGHTGRAY);
     currentY += lineHeight * 2;
     
     // Purple Apple
     DrawRectangle(leftMargin - 35, currentY - 2, 25, 25, GameConstants::PURPLE_COLOR);
-    std::string purpleText = "Purple Apple (Purple) - 3%: Teleport to random location";
-    DrawText(purpleText.c_str(), leftMargin, currentY, textFontSize, WHITE);
-    std::string purpleSubText = "  No growth, cannot be eaten when poisoned";
-    DrawText(purpleSubText.c_str(), leftMargin + 10, currentY + lineHeight - 5, textFontSize - 2, LIGHTGRAY);
+    DrawText("Purple Apple (Purple) - 3%: Teleport to random location", leftMargin, currentY, textFontSize, WHITE);
+    DrawText("  No growth, cannot be eaten when poisoned", leftMargin + 10, currentY + lineHeight - 5, textFontSize - 2, LIGHTGRAY);
     currentY += lineHeight * 2 + 20;
     
     // Controls header
-    std::string controlsHeader = "CONTROLS";
-    int controlsHeaderWidth = MeasureText(controlsHeader.c_str(), headerFontSize);
-    int controlsHeaderX = (GameConstants::SCREEN_WIDTH - controlsHeaderWidth) / 2;
-    DrawText(controlsHeader.c_str(), controlsHeaderX, currentY, headerFontSize, YELLOW);
+    static const StaticText controlsHeader("CONTROLS", headerFontSize);
+    DrawText(controlsHeader.text, CenteredX(controlsHeader.width), currentY, headerFontSize, YELLOW);
     currentY += lineHeight + 10;
     
     // Controls
@@ -144,10 +314,8 @@ void Renderer::DrawInstructionsScreen() {
     currentY += lineHeight * 2;
     
     // Start prompt
-    std::string startText = "Press SPACE or ENTER to start";
-    int startTextWidth = MeasureText(startText.c_str(), textFontSize + 4);
-    int startTextX = (GameConstants::SCREEN_WIDTH - startTextWidth) / 2;
-    DrawText(startText.c_str(), startTextX, currentY, textFontSize + 4, GREEN);
+    static const StaticText start("Press SPACE or ENTER to start", textFontSize + 4);
+    DrawText(start.text, CenteredX(start.width), currentY, start.fontSize, GREEN);
 }
 
 void Renderer::DrawGame(const GameState& state) {
@@ -158,177 +326,311 @@ void Renderer::DrawGame(const GameState& state) {
     DrawRectangle(0, 0, GameConstants::SCREEN_WIDTH, GameConstants::SCORE_AREA_HEIGHT, BLACK);
     
     // Draw score text
-    const int fontSize = 40;
-    std::string scoreText = "Score: " + std::to_string(state.score);
-    int textWidth = MeasureText(scoreText.c_str(), fontSize);
-    int textX = (GameConstants::SCREEN_WIDTH - textWidth) / 2;
-    int textY = (GameConstants::SCORE_AREA_HEIGHT - fontSize) / 2;
-    DrawText(scoreText.c_str(), textX, textY, fontSize, WHITE);
+    static CachedText scoreText("Score: %d", 40);
+    scoreText.Set(state.score);
+    int textY = (GameConstants::SCORE_AREA_HEIGHT - scoreText.fontSize) / 2;
+    DrawText(scoreText.text, CenteredX(scoreText.width), textY, scoreText.fontSize, WHITE);
     
     // Draw high score text
-    const int highScoreFontSize = 24;
-    std::string highScoreText = "High: " + std::to_string(state.GetCurrentHighScore());
-    int highScoreX = GameConstants::SCREEN_WIDTH - MeasureText(highScoreText.c_str(), highScoreFontSize) - 20;
-    int highScoreY = (GameConstants::SCORE_AREA_HEIGHT - highScoreFontSize) / 2;
-    DrawText(highScoreText.c_str(), highScoreX, highScoreY, highScoreFontSize, LIGHTGRAY);
+    static CachedText highScoreText("High: %d", 24);
+    highScoreText.Set(state.GetCurrentHighScore());
+    int highScoreX = GameConstants::SCREEN_WIDTH - highScoreText.width - 20;
+    int highScoreY = (GameConstants::SCORE_AREA_HEIGHT - highScoreText.fontSize) / 2;
+    DrawText(highScoreText.text, highScoreX, highScoreY, highScoreText.fontSize, LIGHTGRAY);
     
     // Draw status effects
     const int statusFontSize = 18;
-    int statusY = highScoreY + highScoreFontSize + 5;
+    int statusY = highScoreY + highScoreText.fontSize + 5;
     int statusRightMargin = 20;
     
-    if (state.cannotEatApples && state.cannotEatTimer > 0.0f) {
-        int countdown = (int)std::ceil(state.cannotEatTimer);
-        std::string statusText = "Poisoned: " + std::to_string(countdown);
-        int statusX = GameConstants::SCREEN_WIDTH - MeasureText(statusText.c_str(), statusFontSize) - statusRightMargin;
-        DrawText(statusText.c_str(), statusX, statusY, statusFontSize, GameConstants::POISON_COLOR);
+    if (state.cannotEatApples && state.TicksLeft(TIMER_CANNOT_EAT) > 0) {
+        static CachedText statusText("Poisoned: %d", statusFontSize);
+        statusText.Set(GameConstants::CeilSeconds(state.TicksLeft(TIMER_CANNOT_EAT)));
+        int statusX = GameConstants::SCREEN_WIDTH - statusText.width - statusRightMargin;
+        DrawText(statusText.text, statusX, statusY, statusFontSize, GameConstants::POISON_COLOR);
         statusY += statusFontSize + 3;
     }
     
-    if (state.canIntersectSelf && state.immunityTimer > 0.0f) {
-        int countdown = (int)std::ceil(state.immunityTimer);
-        std::string statusText = "Resistance: " + std::to_string(countdown);
-        int statusX = GameConstants::SCREEN_WIDTH - MeasureText(statusText.c_str(), statusFontSize) - statusRightMargin;
-        DrawText(statusText.c_str(), statusX, statusY, statusFontSize, GameConstants::GOLD_COLOR);
+    if (state.canIntersectSelf && state.TicksLeft(TIMER_IMMUNITY) > 0) {
+        static CachedText statusText("Resistance: %d", statusFontSize);
+        statusText.Set(GameConstants::CeilSeconds(state.TicksLeft(TIMER_IMMUNITY)));
+        int statusX = GameConstants::SCREEN_WIDTH - statusText.width - statusRightMargin;
+        DrawText(statusText.text, statusX, statusY, statusFontSize, GameConstants::GOLD_COLOR);
         statusY += statusFontSize + 3;
     }
     
-    if (state.canPassWalls && state.wallImmunityTimer > 0.0f) {
-        int countdown = (int)std::ceil(state.wallImmunityTimer);
-        std::string statusText = "Resistance II: " + std::to_string(countdown);
-        int statusX = GameConstants::SCREEN_WIDTH - MeasureText(statusText.c_str(), statusFontSize) - statusRightMargin;
-        DrawText(statusText.c_str(), statusX, statusY, statusFontSize, GameConstants::ENCHANTED_GOLD_COLOR);
-    }
-    
-    // Draw white border
-    int boardStartY = GameConstants::BOARD_START_Y;
-    int cellSize = GameConstants::CELL_SIZE;
-    for (int col = 0; col < GameConstants::TOTAL_GRID_WIDTH; col++) {
-        DrawRectangle(col * cellSize, boardStartY, cellSize, cellSize, WHITE);
-    }
-    for (int col = 0; col < GameConstants::TOTAL_GRID_WIDTH; col++) {
-        DrawRectangle(col * cellSize, boardStartY + (GameConstants::TOTAL_GRID_HEIGHT - 1) * cellSize, cellSize, cellSize, WHITE);
-    }
-    for (int row = 1; row < GameConstants::TOTAL_GRID_HEIGHT - 1; row++) {
-        DrawRectangle(0, boardStartY + row * cellSize, cellSize, cellSize, WHITE);
-    }
-    for (int row = 1; row < GameConstants::TOTAL_GRID_HEIGHT - 1; row++) {
-        DrawRectangle((GameConstants::TOTAL_GRID_WIDTH - 1) * cellSize, boardStartY + row * cellSize, cellSize, cellSize, WHITE);
-    }
-    
-    // Draw checkerboard
-    for (int row = 0; row < GameConstants::GRID_HEIGHT; row++) {
-        for (int col = 0; col < GameConstants::GRID_WIDTH; col++) {
-            int screenCol = (col + GameConstants::BORDER_OFFSET) * cellSize;
-            int screenRow = boardStartY + (row + GameConstants::BORDER_OFFSET) * cellSize;
-            if ((row + col) % 2 == 0) {
-                DrawRectangle(screenCol, screenRow, cellSize, cellSize, BLACK);
-            } else {
-                DrawRectangle(screenCol, screenRow, cellSize, cellSize, GameConstants::GRAY_COLOR);
-            }
-        }
-    }
-    
-    // Draw apples
-    for (const auto& apple : state.apples) {
-        Color foodColor;
-        if (apple.type == POMME_SUPREME) {
-            foodColor = GameConstants::ENCHANTED_GOLD_COLOR;
-        } else if (apple.type == POMME_PLUS) {
-            foodColor = GameConstants::GOLD_COLOR;
-        } else if (apple.type == POISONOUS) {
-            foodColor = GameConstants::POISON_COLOR;
-        } else if (apple.type == TELEPORT) {
-            foodColor = GameConstants::PURPLE_COLOR;
-        } else {
-            foodColor = RED;
-        }
-        DrawRectangle((apple.col + GameConstants::BORDER_OFFSET) * cellSize, 
-                     boardStartY + (apple.row + GameConstants::BORDER_OFFSET) * cellSize, 
-                     cellSize, cellSize, foodColor);
-    }
-    
-    // Draw snake
-    for (size_t i = 1; i < state.snake.size(); i++) {
-        const auto& segment = state.snake[i];
-        DrawRectangle((segment.col + GameConstants::BORDER_OFFSET) * cellSize, 
-                     boardStartY + (segment.row + GameConstants::BORDER_OFFSET) * cellSize, 
-                     cellSize, cellSize, GameConstants::SNAKE_COLOR);
+    if (state.canPassWalls && state.TicksLeft(TIMER_WALL_IMMUNITY) > 0) {
+        static CachedText statusText("Resistance II: %d", statusFontSize);
+        statusText.Set(GameConstants::CeilSeconds(state.TicksLeft(TIMER_WALL_IMMUNITY)));
+        int statusX = GameConstants::SCREEN_WIDTH - statusText.width - statusRightMargin;
+        DrawText(statusText.text, statusX, statusY, statusFontSize, GameConstants::ENCHANTED_GOLD_COLOR);
     }
     
-    if (!state.snake.empty()) {
-        const auto& head = state.snake[0];
-        DrawRectangle((head.col + GameConstants::BORDER_OFFSET) * cellSize, 
-                     boardStartY + (head.row + GameConstants::BORDER_OFFSET) * cellSize, 
-                     cellSize, cellSize, GameConstants::SNAKE_HEAD_COLOR);
-    }
+    // Draw the visible part of the board, apples and snake
+    DrawBoard(state);
 }
 
-void Renderer::DrawGameOverScreen(const GameState& state) {
+void Renderer::DrawGameOverScreen(const GameState& state, bool canRetry) {
     DrawRectangle(0, 0, GameConstants::SCREEN_WIDTH, GameConstants::SCREEN_HEIGHT, {0, 0, 0, 180});
     
-    const int gameOverFontSize = 60;
-    std::string gameOverText = "GAME OVER";
-    int gameOverTextWidth = MeasureText(gameOverText.c_str(), gameOverFontSize);
-    int gameOverX = (GameConstants::SCREEN_WIDTH - gameOverTextWidth) / 2;
+    static const StaticText gameOver("GAME OVER", 60);
     int gameOverY = GameConstants::SCREEN_HEIGHT / 2 - 100;
-    DrawText(gameOverText.c_str(), gameOverX, gameOverY, gameOverFontSize, WHITE);
+    DrawText(gameOver.text, CenteredX(gameOver.width), gameOverY, gameOver.fontSize, WHITE);
     
     const int finalScoreFontSize = 40;
-    std::string finalScoreText = "Final Score: " + std::to_string(state.score);
-    int finalScoreTextWidth = MeasureText(finalScoreText.c_str(), finalScoreFontSize);
-    int finalScoreX = (GameConstants::SCREEN_WIDTH - finalScoreTextWidth) / 2;
+    static CachedText finalScoreText("Final Score: %d", finalScoreFontSize);
+    finalScoreText.Set(state.score);
     int finalScoreY = gameOverY + 80;
-    DrawText(finalScoreText.c_str(), finalScoreX, finalScoreY, finalScoreFontSize, WHITE);
+    DrawText(finalScoreText.text, CenteredX(finalScoreText.width), finalScoreY, finalScoreFontSize, WHITE);
     
-    std::string highScoreText = "High Score: " + std::to_string(state.GetCurrentHighScore());
-    int highScoreTextWidth = MeasureText(highScoreText.c_str(), finalScoreFontSize);
-    int highScoreX = (GameConstants::SCREEN_WIDTH - highScoreTextWidth) / 2;
+    static CachedText highScoreText("High Score: %d", finalScoreFontSize);
+    highScoreText.Set(state.GetCurrentHighScore());
     int highScoreY = finalScoreY + 60;
-    DrawText(highScoreText.c_str(), highScoreX, highScoreY, finalScoreFontSize, YELLOW);
+    DrawText(highScoreText.text, CenteredX(highScoreText.width), highScoreY, finalScoreFontSize, YELLOW);
     
     const int instructionFontSize = 24;
-    std::string restartText = "Press R or SPACE to restart";
-    std::string menuText = "Press M to return to menu";
-    std::string quitText = "Press ESC to exit or Q to quit";
-    int restartTextWidth = MeasureText(restartText.c_str(), instructionFontSize);
-    int menuTextWidth = MeasureText(menuText.c_str(), instructionFontSize);
-    int quitTextWidth = MeasureText(quitText.c_str(), instructionFontSize);
-    int restartX = (GameConstants::SCREEN_WIDTH - restartTextWidth) / 2;
-    int menuX = (GameConstants::SCREEN_WIDTH - menuTextWidth) / 2;
-    int quitX = (GameConstants::SCREEN_WIDTH - quitTextWidth) / 2;
+    static const StaticText restart("Press R or SPACE to restart", instructionFontSize);
+    static const StaticText menu("Press M to return to menu", instructionFontSize);
+    static const StaticText quit("Press ESC to exit or Q to quit", instructionFontSize);
     int instructionY = highScoreY + 80;
-    DrawText(restartText.c_str(), restartX, instructionY, instructionFontSize, LIGHTGRAY);
-    DrawText(menuText.c_str(), menuX, instructionY + 35, instructionFontSize, LIGHTGRAY);
-    DrawText(quitText.c_str(), quitX, instructionY + 70, instructionFontSize, LIGHTGRAY);
+    DrawText(restart.text, CenteredX(restart.width), instructionY, instructionFontSize, LIGHTGRAY);
+    DrawText(menu.text, CenteredX(menu.width), instructionY + 35, instructionFontSize, LIGHTGRAY);
+    DrawText(quit.text, CenteredX(quit.width), instructionY + 70, instructionFontSize, LIGHTGRAY);
+    if (canRetry) {
+        static CachedText retry("Press T to retry from %d seconds earlier", instructionFontSize);
+        retry.Set(GameConstants::RETRY_SECONDS);
+        DrawText(retry.text, CenteredX(retry.width), instructionY + 105, instructionFontSize, LIGHTGRAY);
+    }
 }
 
 void Renderer::DrawPauseScreen(const GameState& state) {
     DrawRectangle(0, 0, GameConstants::SCREEN_WIDTH, GameConstants::SCREEN_HEIGHT, {0, 0, 0, 180});
     
-    const int pauseFontSize = 60;
-    std::string pauseText = "PAUSED";
-    int pauseTextWidth = MeasureText(pauseText.c_str(), pauseFontSize);
-    int pauseX = (GameConstants::SCREEN_WIDTH - pauseTextWidth) / 2;
+    static const StaticText pause("PAUSED", 60);
     int pauseY = GameConstants::SCREEN_HEIGHT / 2 - 30;
-    DrawText(pauseText.c_str(), pauseX, pauseY, pauseFontSize, WHITE);
+    DrawText(pause.text, CenteredX(pause.width), pauseY, pause.fontSize, WHITE);
     
-    const int instructionFontSize = 24;
-    std::string resumeText = "Press P to resume (or Q to quit)";
-    int resumeTextWidth = MeasureText(resumeText.c_str(), instructionFontSize);
-    int resumeX = (GameConstants::SCREEN_WIDTH - resumeTextWidth) / 2;
-    DrawText(resumeText.c_str(), resumeX, pauseY + 80, instructionFontSize, LIGHTGRAY);
+    static const StaticText resume("Press P to resume (or Q to quit)", 24);
+    DrawText(resume.text, CenteredX(resume.width), pauseY + 80, resume.fontSize, LIGHTGRAY);
 }
 
 void Renderer::DrawResumeCountdown(const GameState& state) {
     DrawRectangle(0, 0, GameConstants::SCREEN_WIDTH, GameConstants::SCREEN_HEIGHT, {0, 0, 0, 180});
     
-    const int resumeFontSize = 40;
-    int countdown = (int)std::ceil(state.resumeDelayTimer);
-    std::string resumeText = "Resuming in " + std::to_string(countdown) + "...";
-    int resumeTextWidth = MeasureText(resumeText.c_str(), resumeFontSize);
-    int resumeX = (GameConstants::SCREEN_WIDTH - resumeTextWidth) / 2;
+    static CachedText resumeText("Resuming in %d...", 40);
+    resumeText.Set(GameConstants::CeilSeconds(state.TicksLeft(TIMER_RESUME)));
     int resumeY = GameConstants::SCREEN_HEIGHT / 2;
-    DrawText(resumeText.c_str(), resumeX, resumeY, resumeFontSize, WHITE);
+    DrawText(resumeText.text, CenteredX(resumeText.width), resumeY, resumeText.fontSize, WHITE);
+}
+
+
+void Renderer::DrawReplayOverlay(const ReplayPlayer& player, float speed, bool paused) {
+    const int fontSize = 20;
+    static CachedText replayText("REPLAY %dx", fontSize);
+    static CachedText pausedReplayText("REPLAY %dx (paused)", fontSize);
+    const CachedText& speedText = (paused ? pausedReplayText : replayText).Set((int)speed);
+    DrawText(speedText.text, 20, 10, fontSize, GREEN);
+    
+    static CachedText tickText("Tick %d / %d", fontSize - 2);
+    tickText.Set((int)player.CurrentTick(), (int)player.EndTick());
+    DrawText(tickText.text, 20, 10 + fontSize + 5, tickText.fontSize, LIGHTGRAY);
+}
+
+void Renderer::DrawAutopilotBadge(const Autopilot::Stats& stats) {
+    const int fontSize = 20;
+    static const StaticText label("AUTOPILOT", fontSize);
+    DrawText(label.text, 20, 10, fontSize, GREEN);
+    
+    // Last decision time, to keep an eye on the budget
+    static CachedText timing("%d us", fontSize - 2);
+    timing.Set((int)stats.lastMicros);
+    DrawText(timing.text, 20, 10 + fontSize + 5, timing.fontSize, LIGHTGRAY);
+}
+
+void Renderer::DrawRewindOverlay(int ticksAvailable) {
+    const int fontSize = 20;
+    static const StaticText label("<< REWIND", fontSize);
+    DrawText(label.text, 20, 10, fontSize, SKYBLUE);
+    
+    static CachedText history("%d.%d s left", fontSize - 2);
+    int tenths = ticksAvailable * 10 / GameConstants::TICK_RATE;
+    history.Set(tenths / 10, tenths % 10);
+    DrawText(history.text, 20, 10 + fontSize + 5, history.fontSize, LIGHTGRAY);
+}
+
+void Renderer::DrawSpectatorOverlay(bool live, int overruns) {
+    const int fontSize = 20;
+    static const StaticText label("SPECTATING", fontSize);
+    DrawText(label.text, 20, 10, fontSize, GREEN);
+    
+    // Resyncs after falling behind the game, or that there is no game yet
+    static const StaticText waiting("Waiting for a game...", fontSize - 2);
+    static CachedText resyncs("%d resyncs", fontSize - 2);
+    const char* status = live ? resyncs.Set(overruns).text : waiting.text;
+    DrawText(status, 20, 10 + fontSize + 5, fontSize - 2, LIGHTGRAY);
+}
+
+void Renderer::DrawArena(const Arena& arena) {
+    ClearBackground(BLACK);
+    
+    // Player score and the number of snakes still alive
+    static CachedText scoreText("Score: %d", 40);
+    scoreText.Set(arena.HasPlayer() ? arena.Player().score : 0);
+    int textY = (GameConstants::SCORE_AREA_HEIGHT - scoreText.fontSize) / 2;
+    DrawText(scoreText.text, CenteredX(scoreText.width), textY, scoreText.fontSize, WHITE);
+    
+    static CachedText aliveText("Alive: %d / %d", 24);
+    aliveText.Set(arena.AliveCount(), (int)arena.Snakes().size());
+    int aliveY = (GameConstants::SCORE_AREA_HEIGHT - aliveText.fontSize) / 2;
+    DrawText(aliveText.text, GameConstants::SCREEN_WIDTH - aliveText.width - 20, aliveY, aliveText.fontSize, LIGHTGRAY);
+    
+    // Follow the player (or the first snake when spectating)
+    const ArenaSnake& focus = arena.Snakes()[0];
+    static Position lastFocus = {0, 0};
+    if (!focus.body.empty()) {
+        lastFocus = focus.body.front();
+    }
+    BoardView view = MakeView(lastFocus, arena.Width(), arena.Height());
+    VisibleCells visible = DrawField(view, arena.Width(), arena.Height());
+    
+    // Apples and bodies straight from the occupancy grid, so the cost only
+    // depends on the view size
+    const OccupancyGrid& grid = arena.Grid();
+    for (int row = visible.row0; row < visible.row1; row++) {
+        for (int col = visible.col0; col < visible.col1; col++) {
+            if (grid.HasSnake(col, row)) {
+                DrawCell(view, {col, row}, GameConstants::BOT_COLOR);
+            } else if (grid.AppleAt(col, row) != OccupancyGrid::NO_APPLE) {
+                DrawCell(view, {col, row}, RED);
+            }
+        }
+    }
+    for (const ArenaSnake& snake : arena.Snakes()) {
+        if (snake.alive && InView(view, snake.body.front().col, snake.body.front().row)) {
+            DrawCell(view, snake.body.front(), GameConstants::BOT_HEAD_COLOR);
+        }
+    }
+    if (arena.PlayerAlive()) {
+        const ArenaSnake& player = arena.Player();
+        for (const Position& segment : player.body) {
+            if (InView(view, segment.col, segment.row)) {
+                DrawCell(view, segment, GameConstants::SNAKE_COLOR);
+            }
+        }
+        DrawCell(view, player.body.front(), GameConstants::SNAKE_HEAD_COLOR);
+    }
+}
+
+void Renderer::DrawArenaGameOverScreen(const Arena& arena) {
+    DrawRectangle(0, 0, GameConstants::SCREEN_WIDTH, GameConstants::SCREEN_HEIGHT, {0, 0, 0, 180});
+    
+    static const StaticText gameOver("GAME OVER", 60);
+    int gameOverY = GameConstants::SCREEN_HEIGHT / 2 - 100;
+    DrawText(gameOver.text, CenteredX(gameOver.width), gameOverY, gameOver.fontSize, WHITE);
+    
+    static CachedText finalScoreText("Final Score: %d", 40);
+    finalScoreText.Set(arena.Player().score);
+    int finalScoreY = gameOverY + 80;
+    DrawText(finalScoreText.text, CenteredX(finalScoreText.width), finalScoreY, finalScoreText.fontSize, WHITE);
+    
+    const int instructionFontSize = 24;
+    static const StaticText restart("Press R or SPACE to restart", instructionFontSize);
+    static const StaticText quit("Press ESC to exit or Q to quit", instructionFontSize);
+    int instructionY = finalScoreY + 80;
+    DrawText(restart.text, CenteredX(restart.width), instructionY, instructionFontSize, LIGHTGRAY);
+    DrawText(quit.text, CenteredX(quit.width), instructionY + 35, instructionFontSize, LIGHTGRAY);
 }
 
+void Renderer::DrawProfilerOverlay(const FrameProfiler& profiler) {
+    const FrameProfiler::Summary& summary = profiler.GetSummary();
+    const int fontSize = 16;
+    const int lineHeight = fontSize + 4;
+    const int panelX = 10;
+    const int panelY = GameConstants::BOARD_START_Y + 10;
+    const int panelWidth = 300;
+    const int histogramHeight = 60;
+    const int panelHeight = 10 + (4 + PHASE_COUNT) * lineHeight + 10 + histogramHeight + lineHeight + 10;
+    DrawRectangle(panelX, panelY, panelWidth, panelHeight, {0, 0, 0, 200});
+    
+    int x = panelX + 10;
+    int y = panelY + 10;
+    
+    // Frame time percentiles, in tenths of a millisecond
+    static CachedText frameText[3] = {
+        {"frame p50  %d.%d ms", fontSize},
+        {"frame p99  %d.%d ms", fontSize},
+        {"frame max  %d.%d ms", fontSize},
+    };
+    const float frameValues[3] = {summary.frameP50, summary.frameP99, summary.frameMax};
+    for (int i = 0; i < 3; i++) {
+        int tenths = (int)(frameValues[i] * 10.0f + 0.5f);
+        frameText[i].Set(tenths / 10, tenths % 10);
+        DrawText(frameText[i].text, x, y, fontSize, i == 0 ? GREEN : (i == 1 ? YELLOW : ORANGE));
+        y += lineHeight;
+    }
+    if (profiler.CsvOpen()) {
+        static const StaticText recording("CSV", fontSize);
+        DrawText(recording.text, panelX + panelWidth - recording.width - 10, panelY + 10, fontSize, RED);
+    }
+    
+    // Average and worst time per frame spent in each phase
+    static CachedText phaseText[PHASE_COUNT] = {
+        {"input          %d / %d us", fontSize},
+        {"autopilot      %d / %d us", fontSize},
+        {"status effects %d / %d us", fontSize},
+        {"apple despawn  %d / %d us", fontSize},
+        {"movement       %d / %d us", fontSize},
+        {"audio          %d / %d us", fontSize},
+        {"draw mode menu %d / %d us", fontSize},
+        {"draw instruct. %d / %d us", fontSize},
+        {"draw game      %d / %d us", fontSize},
+        {"draw arena     %d / %d us", fontSize},
+        {"draw pause     %d / %d us", fontSize},
+        {"draw countdown %d / %d us", fontSize},
+        {"draw game over %d / %d us", fontSize},
+        {"draw arena end %d / %d us", fontSize},
+        {"draw replay    %d / %d us", fontSize},
+        {"draw autopilot %d / %d us", fontSize},
+        {"draw rewind    %d / %d us", fontSize},
+        {"draw spectator %d / %d us", fontSize},
+        {"draw profiler  %d / %d us", fontSize},
+        {"present        %d / %d us", fontSize},
+    };
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        phaseText[p].Set((int)(summary.phaseAverage[p] + 0.5f), (int)(summary.phaseMax[p] + 0.5f));
+        DrawText(phaseText[p].text, x, y, fontSize, LIGHTGRAY);
+        y += lineHeight;
+    }
+    
+    // Median and worst time from a key poll to the move it turned, over the last turns
+    static CachedText latencyText("input latency  %d / %d ms", fontSize);
+    static const StaticText noLatency("input latency  -", fontSize);
+    if (summary.latencyCount > 0) {
+        latencyText.Set((int)(summary.latencyP50 + 0.5f), (int)(summary.latencyMax + 0.5f));
+        DrawText(latencyText.text, x, y, fontSize, SKYBLUE);
+    } else {
+        DrawText(noLatency.text, x, y, fontSize, GRAY);
+    }
+    y += lineHeight;
+    
+    // Frame-time histogram over the window, scaled to the fullest bucket
+    y += 10;
+    int tallest = 1;
+    for (int count : summary.histogram) {
+        tallest = std::max(tallest, count);
+    }
+    const int barWidth = (panelWidth - 20) / FrameProfiler::HISTOGRAM_BUCKETS;
+    for (int b = 0; b < FrameProfiler::HISTOGRAM_BUCKETS; b++) {
+        int height = summary.histogram[b] * histogramHeight / tallest;
+        if (summary.histogram[b] > 0 && height == 0) {
+            height = 1;
+        }
+        // Buckets past one 60 Hz frame are the hitches
+        Color color = ((b + 1) * FrameProfiler::BUCKET_MS > 1000.0f / GameConstants::TICK_RATE) ? RED : GREEN;
+        DrawRectangle(x + b * barWidth, y + histogramHeight - height, barWidth - 2, height, color);
+    }
+    y += histogramHeight + 4;
+    static CachedText axisText("0 .. %d+ ms", fontSize - 2);
+    axisText.Set((int)((FrameProfiler::HISTOGRAM_BUCKETS - 1) * FrameProfiler::BUCKET_MS));
+    DrawText(axisText.text, x, y, axisText.fontSize, GRAY);
+}
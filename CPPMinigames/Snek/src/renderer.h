@@ -1,14 +1,32 @@
 #pragma once
 
 #include "game_state.h"
+#include "replay.h"
+#include "autopilot.h"
+#include "arena.h"
+#include "frame_profiler.h"
 
 class Renderer {
 public:
     static void DrawModeSelectionScreen(const GameState& state);
     static void DrawInstructionsScreen();
     static void DrawGame(const GameState& state);
-    static void DrawGameOverScreen(const GameState& state);
+    static void DrawGameOverScreen(const GameState& state, bool canRetry = false);
     static void DrawPauseScreen(const GameState& state);
     static void DrawResumeCountdown(const GameState& state);
+    static void DrawReplayOverlay(const ReplayPlayer& player, float speed, bool paused);
+    static void DrawAutopilotBadge(const Autopilot::Stats& stats);
+    static void DrawRewindOverlay(int ticksAvailable);
+    static void DrawSpectatorOverlay(bool live, int overruns);
+    static void DrawArena(const Arena& arena);
+    static void DrawArenaGameOverScreen(const Arena& arena);
+    // F3 debug overlay: frame-time percentiles, per-phase timings and a frame-time histogram
+    static void DrawProfilerOverlay(const FrameProfiler& profiler);
+    
+    // Release cached GPU resources (call before CloseWindow)
+    static void Unload();
+
+private:
+    static void DrawBoard(const GameState& state);
 };
 
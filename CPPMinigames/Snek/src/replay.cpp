@@ -0,0 +1,243 @@
+#include "replay.h"
+#include "game_logic.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    const char MAGIC[4] = {'S', 'N', 'K', 'R'};
+    // Magic, version, mode, seed, board width and height
+    const size_t HEADER_SIZE = 4 + 1 + 1 + 8 + 2 + 2;
+    
+    // Direction payloads: up, down, left, right
+    const Direction DIRECTIONS[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+    
+    uint8_t EncodeDirection(Direction direction) {
+        for (uint8_t i = 0; i < 4; i++) {
+            if (DIRECTIONS[i].dx == direction.dx && DIRECTIONS[i].dy == direction.dy) {
+                return i;
+            }
+        }
+        return 0;
+    }
+    
+    void WriteVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+    
+    bool ReadVarint(const std::vector<uint8_t>& in, size_t& pos, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+            uint8_t byte = in[pos++];
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+bool Replay::Parse(const std::vector<uint8_t>& data) {
+    events.clear();
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), MAGIC, 4) != 0 || data[4] != VERSION) {
+        return false;
+    }
+    
+    mode = (GameMode)data[5];
+    seed = 0;
+    for (int i = 0; i < 8; i++) {
+        seed |= (uint64_t)data[6 + i] << (8 * i);
+    }
+    
+    boardWidth = data[14] | (data[15] << 8);
+    boardHeight = data[16] | (data[17] << 8);
+    size_t pos = HEADER_SIZE;
+    uint32_t tick = 0;
+    while (pos < data.size()) {
+        uint64_t key;
+        if (!ReadVarint(data, pos, key)) {
+            return false;
+        }
+        
+        ReplayEvent event = {};
+        tick += (uint32_t)(key >> 3);
+        event.tick = tick;
+        event.type = (ReplayEventType)(key & 7);
+        
+        if (event.type == REPLAY_DIRECTION) {
+            if (pos >= data.size() || data[pos] > 3) {
+                return false;
+            }
+            event.direction = DIRECTIONS[data[pos++]];
+        } else if (event.type == REPLAY_END) {
+            endTick = tick;
+            return true;
+        } else if (event.type != REPLAY_PAUSE && event.type != REPLAY_QUIT) {
+            return false;
+        }
+        events.push_back(event);
+    }
+    
+    // Truncated log (e.g. the game was killed): play what we have
+    endTick = tick;
+    return true;
+}
+
+bool Replay::LoadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return Parse(data);
+}
+
+void ReplayRecorder::Begin(const GameState& state) {
+    data.clear();
+    for (char c : MAGIC) {
+        data.push_back((uint8_t)c);
+    }
+    data.push_back(Replay::VERSION);
+    data.push_back((uint8_t)state.gameMode);
+    for (int i = 0; i < 8; i++) {
+        data.push_back((uint8_t)(state.seed >> (8 * i)));
+    }
+    data.push_back((uint8_t)state.boardWidth);
+    data.push_back((uint8_t)(state.boardWidth >> 8));
+    data.push_back((uint8_t)state.boardHeight);
+    data.push_back((uint8_t)(state.boardHeight >> 8));
+    lastTick = 0;
+    recording = true;
+}
+
+void ReplayRecorder::WriteRecord(uint32_t tick, ReplayEventType type) {
+    WriteVarint(data, ((uint64_t)(tick - lastTick) << 3) | type);
+    lastTick = tick;
+}
+
+void ReplayRecorder::RecordDirection(uint32_t tick, Direction direction) {
+    if (!recording) {
+        return;
+    }
+    WriteRecord(tick, REPLAY_DIRECTION);
+    data.push_back(EncodeDirection(direction));
+}
+
+void ReplayRecorder::RecordPauseToggle(uint32_t tick) {
+    if (recording) {
+        WriteRecord(tick, REPLAY_PAUSE);
+    }
+}
+
+void ReplayRecorder::RecordQuit(uint32_t tick) {
+    if (recording) {
+        WriteRecord(tick, REPLAY_QUIT);
+    }
+}
+
+void ReplayRecorder::End(uint32_t tick) {
+    if (recording) {
+        WriteRecord(tick, REPLAY_END);
+        recording = false;
+    }
+}
+
+bool ReplayRecorder::SaveToFile(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write((const char*)data.data(), data.size());
+    return (bool)file;
+}
+
+void ReplayPlayer::Start(const Replay& replay, GameState& state) {
+    this->replay = &replay;
+    nextEvent = 0;
+    tick = 0;
+    keyframes.clear();
+    
+    state.SetBoardSize(replay.boardWidth, replay.boardHeight);
+    state.Initialize(replay.seed);
+    state.gameMode = replay.mode;
+    state.Reset(replay.seed);
+    AddKeyframe(state);
+}
+
+void ReplayPlayer::AddKeyframe(const GameState& state) {
+    keyframes.emplace_back();
+    Keyframe& keyframe = keyframes.back();
+    keyframe.tick = tick;
+    keyframe.nextEvent = nextEvent;
+    keyframe.frame.Capture(state);
+    keyframe.board.Capture(state);
+}
+
+void ReplayPlayer::ApplyEvents(GameState& state) {
+    while (nextEvent < replay->events.size() && replay->events[nextEvent].tick == tick) {
+        const ReplayEvent& event = replay->events[nextEvent++];
+        switch (event.type) {
+            case REPLAY_DIRECTION: GameLogic::QueueDirection(state, event.direction); break;
+            case REPLAY_PAUSE: GameLogic::TogglePause(state); break;
+            case REPLAY_QUIT: GameLogic::Quit(state); break;
+            case REPLAY_END: break;
+        }
+    }
+}
+
+bool ReplayPlayer::Step(GameState& state) {
+    if (Finished()) {
+        // Inputs logged on the final tick (e.g. a quit) still apply
+        if (replay) {
+            ApplyEvents(state);
+        }
+        return false;
+    }
+    
+    ApplyEvents(state);
+    GameLogic::Step(state);
+    tick++;
+    
+    if (tick % KEYFRAME_INTERVAL == 0 && tick > keyframes.back().tick) {
+        AddKeyframe(state);
+    }
+    return true;
+}
+
+void ReplayPlayer::SeekTo(GameState& state, uint32_t target) {
+    if (!replay) {
+        return;
+    }
+    if (target > replay->endTick) {
+        target = replay->endTick;
+    }
+    
+    // Restore the latest keyframe at or before the target, unless we are already closer
+    if (target < tick || target - tick > KEYFRAME_INTERVAL) {
+        size_t k = keyframes.size();
+        while (k > 1 && keyframes[k - 1].tick > target) {
+            k--;
+        }
+        const Keyframe& keyframe = keyframes[k - 1];
+        if (target < tick || keyframe.tick > tick) {
+            tick = keyframe.tick;
+            nextEvent = keyframe.nextEvent;
+            keyframe.board.Apply(state);
+            keyframe.frame.Apply(state);
+        }
+    }
+    
+    while (tick < target) {
+        Step(state);
+    }
+    if (Finished()) {
+        Step(state);
+    }
+    // Nothing should react to what happened in the skipped ticks
+    state.events.Clear();
+}
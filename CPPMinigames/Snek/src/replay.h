@@ -0,0 +1,98 @@
+#pragma once
+
+#include "game_state.h"
+#include "game_snapshot.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compact binary replay log of one game session.
+//
+// Layout (little endian): "SNKR", version byte, GameMode byte, 64-bit seed,
+// 16-bit board width and height, then one record per input. Each record starts with a LEB128 varint of
+// (ticks since previous record << 3 | type), followed by one direction byte
+// for REPLAY_DIRECTION and nothing otherwise. A tick is one fixed
+// GameLogic::Step; inputs recorded at tick N are applied just before step N
+// runs, so the log alone reproduces the game at any frame rate.
+enum ReplayEventType : uint8_t {
+    REPLAY_DIRECTION,    // Direction accepted into the direction queue
+    REPLAY_PAUSE,        // User pause toggle
+    REPLAY_QUIT,         // Game ended early with Q
+    REPLAY_END           // Last tick of the session
+};
+
+struct ReplayEvent {
+    uint32_t tick;
+    ReplayEventType type;
+    Direction direction;
+};
+
+struct Replay {
+    static constexpr uint8_t VERSION = 4;
+    
+    uint64_t seed = 0;
+    GameMode mode = MODE_REGULAR;
+    int boardWidth = GameConstants::GRID_WIDTH;
+    int boardHeight = GameConstants::GRID_HEIGHT;
+    uint32_t endTick = 0;
+    std::vector<ReplayEvent> events;
+    
+    // Parse a log; returns false if the data is not a valid replay
+    bool Parse(const std::vector<uint8_t>& data);
+    bool LoadFromFile(const std::string& path);
+};
+
+class ReplayRecorder {
+public:
+    void Begin(const GameState& state);
+    bool IsRecording() const { return recording; }
+    
+    void RecordDirection(uint32_t tick, Direction direction);
+    void RecordPauseToggle(uint32_t tick);
+    void RecordQuit(uint32_t tick);
+    void End(uint32_t tick);
+    
+    const std::vector<uint8_t>& Data() const { return data; }
+    bool SaveToFile(const std::string& path) const;
+
+private:
+    void WriteRecord(uint32_t tick, ReplayEventType type);
+    
+    std::vector<uint8_t> data;
+    uint32_t lastTick = 0;
+    bool recording = false;
+};
+
+// Re-simulates a replay, keeping periodic keyframe snapshots of the state
+// (a SnapshotFrame and SnapshotBoard, so a few hundred bytes plus the snake
+// on any board size) so playback can seek backwards without starting over.
+class ReplayPlayer {
+public:
+    static constexpr uint32_t KEYFRAME_INTERVAL = 600;
+    
+    void Start(const Replay& replay, GameState& state);
+    
+    // Advance one tick; returns false once the replay has ended
+    bool Step(GameState& state);
+    void SeekTo(GameState& state, uint32_t tick);
+    
+    uint32_t CurrentTick() const { return tick; }
+    uint32_t EndTick() const { return replay ? replay->endTick : 0; }
+    bool Finished() const { return !replay || tick >= replay->endTick; }
+
+private:
+    struct Keyframe {
+        uint32_t tick;
+        size_t nextEvent;
+        SnapshotFrame frame;
+        SnapshotBoard board;
+    };
+    
+    void ApplyEvents(GameState& state);
+    void AddKeyframe(const GameState& state);
+    
+    const Replay* replay = nullptr;
+    size_t nextEvent = 0;
+    uint32_t tick = 0;
+    std::vector<Keyframe> keyframes;
+};
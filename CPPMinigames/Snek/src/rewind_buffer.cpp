@@ -0,0 +1,108 @@
+#include "rewind_buffer.h"
+#include <algorithm>
+
+RewindBuffer::RewindBuffer(int seconds) {
+    int ticks = std::max(1, seconds) * GameConstants::TICK_RATE;
+    frames.resize(ticks);
+    keyframes.resize(ticks / KEYFRAME_INTERVAL + 2);
+    journal.Allocate(ticks * OPS_PER_TICK);
+}
+
+void RewindBuffer::Attach(GameState& state) {
+    framesWritten = 0;
+    firstFrame = 0;
+    keyframesWritten = 0;
+    sinceKeyframe = 0;
+    journal.Clear();
+    for (Keyframe& keyframe : keyframes) {
+        keyframe.serial = 0;
+    }
+    state.journal = &journal;
+}
+
+void RewindBuffer::Detach(GameState& state) {
+    if (state.journal == &journal) {
+        state.journal = nullptr;
+    }
+}
+
+void RewindBuffer::Capture(const GameState& state) {
+    if (keyframesWritten == 0 || journal.Broken() || sinceKeyframe >= KEYFRAME_INTERVAL ||
+        !journal.Holds(keyframes[keyframesWritten % keyframes.size()].opsStart)) {
+        uint32_t serial = ++keyframesWritten;
+        Keyframe& keyframe = keyframes[serial % keyframes.size()];
+        keyframe.serial = serial;
+        keyframe.frame = framesWritten;
+        keyframe.opsStart = journal.Written();
+        keyframe.board.Capture(state);
+        journal.Mend();
+        sinceKeyframe = 0;
+    }
+    sinceKeyframe++;
+    
+    Frame& frame = frames[framesWritten % frames.size()];
+    frame.keyframe = keyframesWritten;
+    frame.opsEnd = journal.Written();
+    frame.state.Capture(state);
+    framesWritten++;
+}
+
+bool RewindBuffer::Restorable(uint32_t n) const {
+    if (n >= framesWritten || n < firstFrame || framesWritten - n > frames.size()) {
+        return false;
+    }
+    const Frame& frame = frames[n % frames.size()];
+    const Keyframe& keyframe = keyframes[frame.keyframe % keyframes.size()];
+    return keyframe.serial == frame.keyframe && journal.Holds(keyframe.opsStart);
+}
+
+int RewindBuffer::Available() const {
+    if (framesWritten == 0) {
+        return 0;
+    }
+    // Keyframes and journal entries are overwritten oldest first, so the
+    // restorable frames are always the newest ones
+    uint32_t newest = framesWritten - 1;
+    uint32_t oldest = newest;
+    while (oldest > 0 && Restorable(oldest - 1)) {
+        oldest--;
+    }
+    return (int)(newest - oldest);
+}
+
+int RewindBuffer::Rewind(GameState& state, int ticks) {
+    int available = Available();
+    int back = std::min(std::max(ticks, 0), available);
+    if (framesWritten == 0) {
+        return 0;
+    }
+    uint32_t target = framesWritten - 1 - back;
+    const Frame& frame = frames[target % frames.size()];
+    Restore(state, frame);
+    
+    // Continue recording from the restored tick
+    const Keyframe& keyframe = keyframes[frame.keyframe % keyframes.size()];
+    // Slots older than the oldest restorable frame hold frames from the
+    // timeline being dropped, which can pass the keyframe and journal checks
+    // again once recording resumes
+    firstFrame = framesWritten - 1 - available;
+    framesWritten = target + 1;
+    keyframesWritten = frame.keyframe;
+    sinceKeyframe = (int)(target - keyframe.frame) + 1;
+    journal.Truncate(frame.opsEnd);
+    return back;
+}
+
+void RewindBuffer::Restore(GameState& state, const Frame& frame) const {
+    const Keyframe& keyframe = keyframes[frame.keyframe % keyframes.size()];
+    BoardJournal* live = state.journal;
+    
+    // The keyframe's board plus the changes since rebuild the snake, apples and grid
+    state.journal = nullptr;
+    keyframe.board.Apply(state);
+    for (uint32_t n = keyframe.opsStart; n != frame.opsEnd; n++) {
+        state.Replay(journal.At(n));
+    }
+    frame.state.Apply(state);
+    state.journal = live;
+}
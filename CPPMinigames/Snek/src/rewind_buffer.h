@@ -0,0 +1,65 @@
+#pragma once
+
+#include "game_state.h"
+#include "game_snapshot.h"
+#include "board_journal.h"
+#include <cstdint>
+#include <vector>
+
+// The last few seconds of a game, one snapshot per tick, for rewinding and
+// retrying. A snapshot is a small fixed-size SnapshotFrame plus the board
+// changes of its tick in a BoardJournal; every KEYFRAME_INTERVAL ticks, or
+// when the journal broke, a SnapshotBoard is taken as well. Restoring
+// rebuilds the board from the keyframe, replays the journal up to the target
+// tick and applies its frame, so nothing is re-simulated and the restored
+// game continues exactly as the original would have. Only keyframes grow
+// with the snake, never with the board; once full, the oldest ticks are
+// overwritten.
+class RewindBuffer {
+public:
+    static constexpr int KEYFRAME_INTERVAL = 30;
+    static constexpr int OPS_PER_TICK = 16;    // Journal room per tick on average
+
+    explicit RewindBuffer(int seconds = 10);
+    RewindBuffer(const RewindBuffer&) = delete;
+    RewindBuffer& operator=(const RewindBuffer&) = delete;
+
+    // Start recording `state` and forget any history (e.g. at the start of a game)
+    void Attach(GameState& state);
+    void Detach(GameState& state);
+
+    // Call after a GameLogic::Step; ticks without a capture (e.g. while
+    // paused) are simply skipped when rewinding
+    void Capture(const GameState& state);
+
+    // Snapshots that can be rewound from the newest one
+    int Available() const;
+    // Restore the snapshot `ticks` captures back (clamped to what is
+    // available) and drop everything newer; returns how far it went back
+    int Rewind(GameState& state, int ticks);
+
+private:
+    struct Frame {
+        uint32_t keyframe;              // Serial of the keyframe it builds on
+        uint32_t opsEnd;                // Journal position after the tick's changes
+        SnapshotFrame state;
+    };
+
+    struct Keyframe {
+        uint32_t serial = 0;            // 0 while unused
+        uint32_t frame = 0;             // Frame taken together with it
+        uint32_t opsStart = 0;
+        SnapshotBoard board;
+    };
+
+    bool Restorable(uint32_t frame) const;
+    void Restore(GameState& state, const Frame& frame) const;
+
+    std::vector<Frame> frames;          // Ring; frame n lives at n % size
+    uint32_t framesWritten = 0;
+    uint32_t firstFrame = 0;            // Oldest frame a rewind left restorable
+    std::vector<Keyframe> keyframes;    // Ring; serial s lives at s % size
+    uint32_t keyframesWritten = 0;
+    int sinceKeyframe = 0;
+    BoardJournal journal;
+};
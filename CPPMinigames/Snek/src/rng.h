@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+// xoshiro256** generator, seeded through splitmix64. Each GameState owns
+// one, so games with the same seed and inputs replay identically and
+// parallel simulations never share generator state.
+class Rng {
+public:
+    Rng() { Seed(0); }
+    explicit Rng(uint64_t seed) { Seed(seed); }
+    
+    void Seed(uint64_t seed) {
+        for (uint64_t& word : s) {
+            seed += 0x9e3779b97f4a7c15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            word = z ^ (z >> 31);
+        }
+    }
+    
+    uint64_t Next() {
+        uint64_t result = Rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = Rotl(s[3], 45);
+        return result;
+    }
+    
+    // Uniform integer in [min, max], inclusive (Lemire's multiply-shift with rejection)
+    int Range(int min, int max) {
+        uint32_t span = (uint32_t)(max - min) + 1;
+        uint64_t product = (uint64_t)(uint32_t)(Next() >> 32) * span;
+        uint32_t low = (uint32_t)product;
+        if (low < span) {
+            uint32_t threshold = (0u - span) % span;
+            while (low < threshold) {
+                product = (uint64_t)(uint32_t)(Next() >> 32) * span;
+                low = (uint32_t)product;
+            }
+        }
+        return min + (int)(product >> 32);
+    }
+    
+    bool operator==(const Rng& other) const {
+        return s[0] == other.s[0] && s[1] == other.s[1] && s[2] == other.s[2] && s[3] == other.s[3];
+    }
+
+private:
+    static uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    
+    uint64_t s[4];
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "game_types.h"
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// Snake segments in a circular buffer (index 0 is the head). Pushing or
+// popping at either end is O(1), and reverse() just flips which end is the
+// head, so a move never shifts the rest of the body.
+class SnakeBody {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Position;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Position*;
+        using reference = const Position&;
+        
+        const_iterator() = default;
+        const_iterator(const SnakeBody* body, int index) : body_(body), index_(index) {}
+        
+        reference operator*() const { return (*body_)[index_]; }
+        pointer operator->() const { return &(*body_)[index_]; }
+        const_iterator& operator++() { index_++; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; index_++; return old; }
+        const_iterator operator+(int n) const { return const_iterator(body_, index_ + n); }
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+        
+    private:
+        const SnakeBody* body_ = nullptr;
+        int index_ = 0;
+    };
+    
+    // Capacity is rounded up to a power of two; the buffer only grows if the
+    // snake outgrows it (overlapping segments can exceed the cell count)
+    void reserve(int capacity) {
+        if (capacity <= (int)cells_.size()) {
+            return;
+        }
+        int newCapacity = 1;
+        while (newCapacity < capacity) {
+            newCapacity <<= 1;
+        }
+        std::vector<Position> cells(newCapacity);
+        for (int i = 0; i < size_; i++) {
+            cells[i] = (*this)[i];
+        }
+        cells_.swap(cells);
+        mask_ = newCapacity - 1;
+        head_ = 0;
+        reversed_ = false;
+    }
+    
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    int capacity() const { return (int)cells_.size(); }
+    
+    const Position& operator[](int i) const { return cells_[Physical(i)]; }
+    const Position& front() const { return cells_[head_]; }
+    const Position& back() const { return cells_[Physical(size_ - 1)]; }
+    
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size_); }
+    
+    void push_front(Position pos) {
+        Grow();
+        head_ = (reversed_ ? head_ + 1 : head_ - 1) & mask_;
+        cells_[head_] = pos;
+        size_++;
+    }
+    void pop_front() {
+        head_ = Physical(1);
+        size_--;
+    }
+    void push_back(Position pos) {
+        Grow();
+        cells_[Physical(size_)] = pos;
+        size_++;
+    }
+    void pop_back() { size_--; }
+    void clear() { size_ = 0; }
+    
+    // Swap head and tail in O(1)
+    void reverse() {
+        if (size_ > 0) {
+            head_ = Physical(size_ - 1);
+            reversed_ = !reversed_;
+        }
+    }
+
+private:
+    unsigned Physical(int i) const {
+        return (reversed_ ? head_ - (unsigned)i : head_ + (unsigned)i) & mask_;
+    }
+    void Grow() {
+        if (size_ == (int)cells_.size()) {
+            reserve(cells_.empty() ? 16 : size_ * 2);
+        }
+    }
+    
+    std::vector<Position> cells_;
+    unsigned mask_ = 0;
+    unsigned head_ = 0;
+    int size_ = 0;
+    bool reversed_ = false;
+};
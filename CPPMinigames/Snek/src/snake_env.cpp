@@ -0,0 +1,185 @@
+#include "snake_env.h"
+#include "board_journal.h"
+#include "game_logic.h"
+#include "game_state.h"
+#include <cstring>
+#include <new>
+
+struct SnakeEnv {
+    SnakeEnvConfig config;
+    GameState state;
+    BoardJournal journal;           // Board changes since the planes were last patched
+    Position head = {0, 0};         // Head cell marked in the head plane
+    bool headMarked = false;
+    uint8_t* planes = nullptr;
+    float* effects = nullptr;
+    int steps = 0;
+    bool done = true;
+};
+
+namespace {
+    const int JOURNAL_CAPACITY = 1024;  // Ops per step before the planes are rewritten instead
+    const int MAX_TICKS_PER_STEP = 10 * GameConstants::TICK_RATE;
+
+    const Direction ACTIONS[SNAKE_ENV_ACTION_COUNT] = {{0, 0}, {0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+
+    uint8_t* Plane(SnakeEnv* env, int plane) {
+        return env->planes + (size_t)plane * env->state.boardWidth * env->state.boardHeight;
+    }
+
+    // Rewrite one cell of every plane from the board
+    void PatchCell(SnakeEnv* env, Position pos) {
+        const GameState& state = env->state;
+        size_t cell = (size_t)pos.row * state.boardWidth + pos.col;
+        Plane(env, SNAKE_ENV_PLANE_BODY)[cell] = state.grid.HasSnake(pos.col, pos.row) ? 1 : 0;
+        int apple = state.grid.AppleAt(pos.col, pos.row);
+        for (int type = 0; type <= TELEPORT; type++) {
+            uint8_t present = (apple != OccupancyGrid::NO_APPLE && state.apples[apple].type == type) ? 1 : 0;
+            Plane(env, SNAKE_ENV_PLANE_REGULAR + type)[cell] = present;
+        }
+    }
+
+    void MarkHead(SnakeEnv* env) {
+        const GameState& state = env->state;
+        if (env->headMarked) {
+            Plane(env, SNAKE_ENV_PLANE_HEAD)[(size_t)env->head.row * state.boardWidth + env->head.col] = 0;
+        }
+        env->headMarked = !state.snake.empty();
+        if (env->headMarked) {
+            env->head = state.snake.front();
+            Plane(env, SNAKE_ENV_PLANE_HEAD)[(size_t)env->head.row * state.boardWidth + env->head.col] = 1;
+        }
+    }
+
+    void WritePlanes(SnakeEnv* env) {
+        const GameState& state = env->state;
+        std::memset(env->planes, 0, (size_t)SNAKE_ENV_PLANE_COUNT * state.boardWidth * state.boardHeight);
+        env->headMarked = false;
+        for (const Position& pos : state.snake) {
+            Plane(env, SNAKE_ENV_PLANE_BODY)[(size_t)pos.row * state.boardWidth + pos.col] = 1;
+        }
+        for (const Apple& apple : state.apples) {
+            Plane(env, SNAKE_ENV_PLANE_REGULAR + apple.type)[(size_t)apple.row * state.boardWidth + apple.col] = 1;
+        }
+        MarkHead(env);
+    }
+
+    // Bring the caller's buffers up to date: cells the journal says changed,
+    // or everything when the board was rebuilt or changed too much
+    void Observe(SnakeEnv* env) {
+        BoardJournal& journal = env->journal;
+        if (env->planes) {
+            if (journal.Broken() || !journal.Holds(0)) {
+                WritePlanes(env);
+            } else {
+                for (uint32_t n = 0; n < journal.Written(); n++) {
+                    const BoardOp& op = journal.At(n);
+                    if (op.type != BoardOp::REVERSE) {
+                        PatchCell(env, op.pos);
+                    }
+                }
+                MarkHead(env);
+            }
+        }
+        journal.Clear();
+
+        if (env->effects) {
+            const GameState& state = env->state;
+            env->effects[SNAKE_ENV_EFFECT_IMMUNITY] =
+                (float)state.TicksLeft(TIMER_IMMUNITY) / GameConstants::IMMUNITY_DURATION;
+            env->effects[SNAKE_ENV_EFFECT_WALL_IMMUNITY] =
+                (float)state.TicksLeft(TIMER_WALL_IMMUNITY) / GameConstants::WALL_IMMUNITY_DURATION;
+            env->effects[SNAKE_ENV_EFFECT_CANNOT_EAT] =
+                (float)state.TicksLeft(TIMER_CANNOT_EAT) / GameConstants::CANNOT_EAT_DURATION;
+            env->effects[SNAKE_ENV_EFFECT_POISON_PAUSE] =
+                (float)state.TicksLeft(TIMER_POISON_PAUSE) / GameConstants::PAUSE_DURATION;
+        }
+    }
+}
+
+extern "C" {
+
+void snake_env_default_config(SnakeEnvConfig* config) {
+    config->board_width = GameConstants::GRID_WIDTH;
+    config->board_height = GameConstants::GRID_HEIGHT;
+    config->mode = SNAKE_ENV_MODE_REGULAR;
+    config->max_steps = 0;
+    config->death_reward = 0.0f;
+}
+
+SnakeEnv* snake_env_create(const SnakeEnvConfig* config) {
+    SnakeEnv* env = new (std::nothrow) SnakeEnv();
+    if (!env) {
+        return nullptr;
+    }
+    if (config) {
+        env->config = *config;
+    } else {
+        snake_env_default_config(&env->config);
+    }
+    env->state.SetBoardSize(env->config.board_width, env->config.board_height);
+    env->state.Initialize(0);
+    env->state.gameMode = (env->config.mode == SNAKE_ENV_MODE_ACCELERATED) ? MODE_ACCELERATED : MODE_REGULAR;
+    env->journal.Allocate(JOURNAL_CAPACITY);
+    env->state.journal = &env->journal;
+    env->state.Reset(0);
+    return env;
+}
+
+void snake_env_destroy(SnakeEnv* env) {
+    delete env;
+}
+
+int snake_env_board_width(const SnakeEnv* env) {
+    return env->state.boardWidth;
+}
+
+int snake_env_board_height(const SnakeEnv* env) {
+    return env->state.boardHeight;
+}
+
+void snake_env_set_buffers(SnakeEnv* env, uint8_t* planes, float* effects) {
+    env->planes = planes;
+    env->effects = effects;
+    env->journal.Break();
+    Observe(env);
+}
+
+void snake_env_reset(SnakeEnv* env, uint64_t seed) {
+    env->state.Reset(seed);
+    env->state.events.Clear();
+    env->steps = 0;
+    env->done = false;
+    Observe(env);
+}
+
+int snake_env_step(SnakeEnv* env, int action, SnakeEnvResult* result) {
+    if (env->done || action < 0 || action >= SNAKE_ENV_ACTION_COUNT) {
+        return -1;
+    }
+    GameState& state = env->state;
+    int score = state.score;
+    if (action != SNAKE_ENV_ACTION_NONE) {
+        GameLogic::QueueDirection(state, ACTIONS[action]);
+    }
+
+    GameLogic::StepToMove(state, MAX_TICKS_PER_STEP);
+    state.events.Clear();
+    env->steps++;
+    Observe(env);
+
+    SnakeEnvResult step;
+    step.reward = (float)(state.score - score) + (state.gameOver ? env->config.death_reward : 0.0f);
+    step.terminated = state.gameOver ? 1 : 0;
+    step.truncated = (!state.gameOver && env->config.max_steps > 0 && env->steps >= env->config.max_steps) ? 1 : 0;
+    step.score = state.score;
+    step.length = state.snake.size();
+    step.ticks = state.tick;
+    env->done = step.terminated || step.truncated;
+    if (result) {
+        *result = step;
+    }
+    return 0;
+}
+
+}
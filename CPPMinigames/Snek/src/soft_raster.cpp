@@ -0,0 +1,346 @@
+#include "soft_raster.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace {
+    // 5x7 glyphs for ASCII 32-126, one byte per column, bit 0 at the top
+    const uint8_t FONT[95][5] = {
+        {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+        {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+        {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+        {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+        {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},
+        {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+        {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+        {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+        {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00},
+        {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14},
+        {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E},
+        {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+        {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+        {0x3E, 0x41, 0x49, 0x49, 0x7A}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+        {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+        {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+        {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+        {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+        {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+        {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+        {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04},
+        {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78},
+        {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F},
+        {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E},
+        {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00},
+        {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78},
+        {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08},
+        {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+        {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+        {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C},
+        {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00},
+        {0x00, 0x41, 0x36, 0x08, 0x00}, {0x10, 0x08, 0x08, 0x10, 0x08},
+    };
+    const int GLYPH_COLUMNS = 5;
+    const int GLYPH_ROWS = 7;
+
+    // raylib's default font: 10-pixel base size, one pixel of spacing per 10
+    const int BASE_FONT_SIZE = 10;
+    const int LINE_SPACING = 2;
+
+    struct ClipRect {
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+    };
+
+    SoftCanvas* screen = nullptr;
+    SoftCanvas* target = nullptr;          // screen, or a render texture in texture mode
+    bool scissor = false;
+    ClipRect scissorRect = {};
+    std::vector<std::unique_ptr<SoftCanvas>> textures;    // Render texture id - 1
+
+    SoftCanvas* FindTexture(unsigned int id) {
+        return (id > 0 && id <= textures.size()) ? textures[id - 1].get() : nullptr;
+    }
+
+    // Drawable part of the target: the canvas, narrowed by the scissor
+    ClipRect Clip() {
+        ClipRect clip = {0, 0, target->Width(), target->Height()};
+        if (scissor) {
+            clip.x0 = std::max(clip.x0, scissorRect.x0);
+            clip.y0 = std::max(clip.y0, scissorRect.y0);
+            clip.x1 = std::min(clip.x1, scissorRect.x1);
+            clip.y1 = std::min(clip.y1, scissorRect.y1);
+        }
+        return clip;
+    }
+
+    Color Blend(Color src, Color dst) {
+        int a = src.a;
+        int inv = 255 - a;
+        return {(unsigned char)((src.r * a + dst.r * inv + 127) / 255),
+                (unsigned char)((src.g * a + dst.g * inv + 127) / 255),
+                (unsigned char)((src.b * a + dst.b * inv + 127) / 255),
+                (unsigned char)(a + (dst.a * inv + 127) / 255)};
+    }
+
+    // Fill [x0, x1) x [y0, y1), already clipped, one row span at a time
+    void FillSpans(int x0, int y0, int x1, int y1, Color color) {
+        if (x0 >= x1 || y0 >= y1 || color.a == 0) {
+            return;
+        }
+        int span = x1 - x0;
+        if (color.a == 255) {
+            for (int y = y0; y < y1; y++) {
+                std::fill_n(target->Row(y) + x0, span, color);
+            }
+            return;
+        }
+        for (int y = y0; y < y1; y++) {
+            Color* row = target->Row(y) + x0;
+            for (int x = 0; x < span; x++) {
+                row[x] = Blend(color, row[x]);
+            }
+        }
+    }
+
+    void FillClipped(const ClipRect& clip, int x0, int y0, int x1, int y1, Color color) {
+        FillSpans(std::max(x0, clip.x0), std::max(y0, clip.y0), std::min(x1, clip.x1), std::min(y1, clip.y1), color);
+    }
+
+    // Each run of lit columns in a glyph row becomes one rectangle
+    void DrawGlyph(const ClipRect& clip, int glyph, int x, int y, float scale, Color color) {
+        const uint8_t* columns = FONT[glyph];
+        for (int row = 0; row < GLYPH_ROWS; row++) {
+            // Glyphs sit one unit below the top of the 10-unit line
+            int top = y + (int)((row + 1) * scale);
+            int bottom = y + (int)((row + 2) * scale);
+            int col = 0;
+            while (col < GLYPH_COLUMNS) {
+                if (!(columns[col] & (1 << row))) {
+                    col++;
+                    continue;
+                }
+                int start = col;
+                while (col < GLYPH_COLUMNS && (columns[col] & (1 << row))) {
+                    col++;
+                }
+                FillClipped(clip, x + (int)(start * scale), top, x + (int)(col * scale), bottom, color);
+            }
+        }
+    }
+
+    int GlyphIndex(char c) {
+        return (c >= 32 && c <= 126) ? c - 32 : '?' - 32;
+    }
+}
+
+void SoftCanvas::Resize(int newWidth, int newHeight) {
+    width = std::max(0, newWidth);
+    height = std::max(0, newHeight);
+    pixels.assign((size_t)width * height, BLACK);
+}
+
+bool SoftCanvas::WritePpm(const std::string& path) const {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<unsigned char> line((size_t)width * 3);
+    bool ok = true;
+    for (int y = 0; y < height && ok; y++) {
+        const Color* row = Row(y);
+        for (int x = 0; x < width; x++) {
+            line[x * 3 + 0] = row[x].r;
+            line[x * 3 + 1] = row[x].g;
+            line[x * 3 + 2] = row[x].b;
+        }
+        ok = std::fwrite(line.data(), 1, line.size(), file) == line.size();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+uint64_t SoftCanvas::Hash() const {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const Color& pixel : pixels) {
+        for (unsigned char byte : {pixel.r, pixel.g, pixel.b}) {
+            hash = (hash ^ byte) * 0x100000001b3ull;
+        }
+    }
+    return hash;
+}
+
+void SetSoftCanvas(SoftCanvas* canvas) {
+    screen = canvas;
+    target = canvas;
+}
+
+void ClearBackground(Color color) {
+    if (!target) {
+        return;
+    }
+    // Like glClear: the scissor applies, and the color replaces rather than blends
+    ClipRect clip = Clip();
+    for (int y = clip.y0; y < clip.y1; y++) {
+        std::fill(target->Row(y) + clip.x0, target->Row(y) + std::max(clip.x0, clip.x1), color);
+    }
+}
+
+void DrawRectangle(int posX, int posY, int width, int height, Color color) {
+    if (!target) {
+        return;
+    }
+    FillClipped(Clip(), posX, posY, posX + width, posY + height, color);
+}
+
+void DrawText(const char* text, int posX, int posY, int fontSize, Color color) {
+    if (!target || !text) {
+        return;
+    }
+    fontSize = std::max(fontSize, BASE_FONT_SIZE);
+    float scale = (float)fontSize / BASE_FONT_SIZE;
+    float advance = GLYPH_COLUMNS * scale + fontSize / BASE_FONT_SIZE;
+    ClipRect clip = Clip();
+    float x = (float)posX;
+    int y = posY;
+    for (const char* c = text; *c; c++) {
+        if (*c == '\n') {
+            x = (float)posX;
+            y += fontSize + LINE_SPACING;
+            continue;
+        }
+        if (*c != ' ') {
+            DrawGlyph(clip, GlyphIndex(*c), (int)x, y, scale, color);
+        }
+        x += advance;
+    }
+}
+
+int MeasureText(const char* text, int fontSize) {
+    if (!text) {
+        return 0;
+    }
+    fontSize = std::max(fontSize, BASE_FONT_SIZE);
+    float scale = (float)fontSize / BASE_FONT_SIZE;
+    int spacing = fontSize / BASE_FONT_SIZE;
+    // Widest line: glyphs plus the spacing between them
+    int widest = 0;
+    int count = 0;
+    for (const char* c = text;; c++) {
+        if (*c == '\n' || *c == '\0') {
+            widest = std::max(widest, count);
+            count = 0;
+            if (*c == '\0') {
+                break;
+            }
+            continue;
+        }
+        count++;
+    }
+    return widest > 0 ? (int)(widest * GLYPH_COLUMNS * scale) + (widest - 1) * spacing : 0;
+}
+
+void BeginScissorMode(int x, int y, int width, int height) {
+    scissor = true;
+    scissorRect = {x, y, x + std::max(0, width), y + std::max(0, height)};
+}
+
+void EndScissorMode() {
+    scissor = false;
+}
+
+RenderTexture2D LoadRenderTexture(int width, int height) {
+    auto canvas = std::make_unique<SoftCanvas>();
+    canvas->Resize(width, height);
+    // Reuse a slot freed by UnloadRenderTexture
+    size_t slot = 0;
+    while (slot < textures.size() && textures[slot]) {
+        slot++;
+    }
+    if (slot == textures.size()) {
+        textures.emplace_back();
+    }
+    textures[slot] = std::move(canvas);
+
+    RenderTexture2D texture = {};
+    texture.id = (unsigned int)slot + 1;
+    texture.texture = {texture.id, width, height, 1, 0};
+    return texture;
+}
+
+void UnloadRenderTexture(RenderTexture2D texture) {
+    if (FindTexture(texture.id)) {
+        if (target == textures[texture.id - 1].get()) {
+            target = screen;
+        }
+        textures[texture.id - 1].reset();
+    }
+}
+
+void BeginTextureMode(RenderTexture2D texture) {
+    target = FindTexture(texture.id);
+}
+
+void EndTextureMode() {
+    target = screen;
+}
+
+void DrawTextureRec(Texture2D texture, Rectangle source, Vector2 position, Color tint) {
+    SoftCanvas* image = FindTexture(texture.id);
+    if (!target || !image || image == target || tint.a == 0) {
+        return;
+    }
+    bool flipX = source.width < 0;
+    // Upright only with a negative height, as with raylib's bottom-up render textures
+    bool upright = source.height < 0;
+    int srcX = (int)source.x;
+    int srcY = (int)source.y;
+    int width = (int)std::abs(source.width);
+    int height = (int)std::abs(source.height);
+    int posX = (int)position.x;
+    int posY = (int)position.y;
+
+    // Clip the destination, then drop rows and columns that fall outside the texture
+    ClipRect clip = Clip();
+    int x0 = std::max(posX, clip.x0);
+    int x1 = std::min(posX + width, clip.x1);
+    int y0 = std::max(posY, clip.y0);
+    int y1 = std::min(posY + height, clip.y1);
+    bool white = tint.r == 255 && tint.g == 255 && tint.b == 255 && tint.a == 255;
+    for (int y = y0; y < y1; y++) {
+        int j = y - posY;
+        int imageRow = upright ? image->Height() - srcY - height + j : image->Height() - 1 - srcY - j;
+        if (imageRow < 0 || imageRow >= image->Height()) {
+            continue;
+        }
+        const Color* src = image->Row(imageRow);
+        Color* dst = target->Row(y);
+        if (!flipX && white) {
+            // Straight row copy of the columns the texture has
+            int xa = std::max(x0, posX - srcX);
+            int xb = std::min(x1, posX + image->Width() - srcX);
+            if (xa < xb) {
+                std::memcpy(dst + xa, src + srcX + (xa - posX), (size_t)(xb - xa) * sizeof(Color));
+            }
+            continue;
+        }
+        for (int x = x0; x < x1; x++) {
+            int i = x - posX;
+            int col = flipX ? srcX + width - 1 - i : srcX + i;
+            if (col < 0 || col >= image->Width()) {
+                continue;
+            }
+            Color pixel = src[col];
+            if (!white) {
+                pixel = {(unsigned char)(pixel.r * tint.r / 255), (unsigned char)(pixel.g * tint.g / 255),
+                         (unsigned char)(pixel.b * tint.b / 255), (unsigned char)(pixel.a * tint.a / 255)};
+                dst[x] = Blend(pixel, dst[x]);
+            } else {
+                dst[x] = pixel;
+            }
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CPU stand-ins for the part of raylib the renderer draws with: the same
+// types, color constants and function signatures, drawing into a SoftCanvas
+// instead of the GPU. Building renderer.cpp with SNAKE_SOFTWARE_RENDER
+// defined swaps these in for raylib.h, so every screen can be drawn on a
+// machine with no GPU or window (golden images, replay-to-image).
+//
+// Rectangles and glyphs are filled as horizontal spans straight into the
+// pixel rows, clipped once per rectangle against the canvas and the scissor.
+// Text uses a built-in fixed-width 5x7 font, scaled and spaced the way raylib
+// scales its 10-pixel default font, so it lands close to where the
+// interactive build puts it.
+
+typedef struct Color { unsigned char r, g, b, a; } Color;
+typedef struct Vector2 { float x, y; } Vector2;
+typedef struct Rectangle { float x, y, width, height; } Rectangle;
+typedef struct Texture { unsigned int id; int width, height, mipmaps, format; } Texture;
+typedef Texture Texture2D;
+typedef struct RenderTexture { unsigned int id; Texture texture; Texture depth; } RenderTexture;
+typedef RenderTexture RenderTexture2D;
+
+#define LIGHTGRAY  Color{200, 200, 200, 255}
+#define GRAY       Color{130, 130, 130, 255}
+#define DARKGRAY   Color{80, 80, 80, 255}
+#define YELLOW     Color{253, 249, 0, 255}
+#define GOLD       Color{255, 203, 0, 255}
+#define ORANGE     Color{255, 161, 0, 255}
+#define PINK       Color{255, 109, 194, 255}
+#define RED        Color{230, 41, 55, 255}
+#define MAROON     Color{190, 33, 55, 255}
+#define GREEN      Color{0, 228, 48, 255}
+#define LIME       Color{0, 158, 47, 255}
+#define DARKGREEN  Color{0, 117, 44, 255}
+#define SKYBLUE    Color{102, 191, 255, 255}
+#define BLUE       Color{0, 121, 241, 255}
+#define DARKBLUE   Color{0, 82, 172, 255}
+#define PURPLE     Color{200, 122, 255, 255}
+#define VIOLET     Color{135, 60, 190, 255}
+#define DARKPURPLE Color{112, 31, 126, 255}
+#define BEIGE      Color{211, 176, 131, 255}
+#define BROWN      Color{127, 106, 79, 255}
+#define DARKBROWN  Color{76, 63, 47, 255}
+#define WHITE      Color{255, 255, 255, 255}
+#define BLACK      Color{0, 0, 0, 255}
+#define BLANK      Color{0, 0, 0, 0}
+#define MAGENTA    Color{255, 0, 255, 255}
+#define RAYWHITE   Color{245, 245, 245, 255}
+
+// Top-down RGBA framebuffer
+class SoftCanvas {
+public:
+    void Resize(int width, int height);
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+    Color* Row(int y) { return pixels.data() + (size_t)y * width; }
+    const Color* Row(int y) const { return pixels.data() + (size_t)y * width; }
+
+    // Binary PPM (alpha dropped)
+    bool WritePpm(const std::string& path) const;
+    // FNV-1a of the RGB bytes, for comparing frames against golden values
+    uint64_t Hash() const;
+
+private:
+    int width = 0;
+    int height = 0;
+    std::vector<Color> pixels;
+};
+
+// Canvas the drawing calls go to outside BeginTextureMode/EndTextureMode
+void SetSoftCanvas(SoftCanvas* canvas);
+
+// raylib subset
+void ClearBackground(Color color);
+void DrawRectangle(int posX, int posY, int width, int height, Color color);
+void DrawText(const char* text, int posX, int posY, int fontSize, Color color);
+int MeasureText(const char* text, int fontSize);
+
+void BeginScissorMode(int x, int y, int width, int height);
+void EndScissorMode();
+
+// Render textures are stored top-down here, but behave like raylib's
+// bottom-up ones when drawn: a negative source height shows them upright.
+// Blits are opaque (the renderer only caches fully opaque layers).
+RenderTexture2D LoadRenderTexture(int width, int height);
+void UnloadRenderTexture(RenderTexture2D target);
+void BeginTextureMode(RenderTexture2D target);
+void EndTextureMode();
+void DrawTextureRec(Texture2D texture, Rectangle source, Vector2 position, Color tint);
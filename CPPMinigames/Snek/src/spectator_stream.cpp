@@ -0,0 +1,508 @@
+#include "spectator_stream.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const uint32_t MAGIC = 0x534B4E53;              // "SNKS"
+
+    enum RecordType : uint8_t { RECORD_KEYFRAME = 1, RECORD_TICK = 2 };
+
+    enum StatusFlag : uint16_t {
+        FLAG_GAME_OVER = 1 << 0,
+        FLAG_PAUSED = 1 << 1,
+        FLAG_USER_PAUSED = 1 << 2,
+        FLAG_RESUMING = 1 << 3,
+        FLAG_CAN_INTERSECT_SELF = 1 << 4,
+        FLAG_CAN_PASS_WALLS = 1 << 5,
+        FLAG_CANNOT_EAT_APPLES = 1 << 6,
+    };
+
+    // Start of the shared region; the ring follows at RING_OFFSET. Offsets
+    // count every byte ever written, so they never wrap.
+    struct StreamHeader {
+        std::atomic<uint32_t> magic;        // Stored last, once the rest is set
+        uint32_t version;
+        uint64_t capacity;                  // Ring bytes, a power of two
+        std::atomic<uint64_t> reserved;     // End of the bytes the writer may be changing
+        std::atomic<uint64_t> published;    // End of the last complete record
+        std::atomic<uint64_t> keyframe;     // Start of the newest keyframe record
+        std::atomic<uint32_t> closed;
+    };
+    const size_t RING_OFFSET = 64;
+    static_assert(sizeof(StreamHeader) <= RING_OFFSET, "stream header must fit before the ring");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory counters must be lock-free");
+
+    // Every record starts with the game's status; the cells and apples follow
+    struct RecordHeader {
+        uint32_t size;              // Whole record, a multiple of 8
+        uint8_t type;
+        uint8_t gameMode;
+        uint16_t flags;
+        uint32_t cells;             // Keyframes: the whole body, head first
+        uint32_t apples;            // Keyframes: every apple
+        uint32_t ops;               // Tick records: the board changes since the last record, in order
+        uint32_t tick;
+        uint32_t gameTicks;
+        int32_t score;
+        int32_t highScore;
+        uint16_t boardWidth;
+        uint16_t boardHeight;
+        uint8_t deathCause;
+        uint8_t padding[3];
+        int32_t ticksLeft[TIMER_KIND_COUNT];
+    };
+
+    struct StreamCell {
+        int16_t col;
+        int16_t row;
+    };
+
+    struct StreamApple {
+        int16_t col;
+        int16_t row;
+        uint8_t type;
+        uint8_t padding[3];
+        uint32_t spawnTick;
+        uint32_t lifetime;
+    };
+
+    // A BoardOp as the reader replays it
+    struct StreamOp {
+        uint8_t type;
+        uint8_t food;               // ADD_APPLE, REMOVE_APPLE
+        int16_t index;              // REMOVE_APPLE
+        int16_t col;
+        int16_t row;
+        uint32_t spawnTick;         // ADD_APPLE
+        uint32_t lifetime;          // ADD_APPLE
+    };
+
+    template <typename T>
+    void Append(std::vector<uint8_t>& out, const T& value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    void AppendCell(std::vector<uint8_t>& out, Position pos) {
+        Append(out, StreamCell{(int16_t)pos.col, (int16_t)pos.row});
+    }
+
+    // Ring copies, split where the ring wraps
+    void CopyIn(uint8_t* ring, uint64_t capacity, uint64_t at, const uint8_t* bytes, size_t size) {
+        size_t offset = (size_t)(at & (capacity - 1));
+        size_t first = std::min(size, (size_t)capacity - offset);
+        std::memcpy(ring + offset, bytes, first);
+        std::memcpy(ring, bytes + first, size - first);
+    }
+
+    void CopyOut(const uint8_t* ring, uint64_t capacity, uint64_t at, void* out, size_t size) {
+        uint8_t* bytes = static_cast<uint8_t*>(out);
+        size_t offset = (size_t)(at & (capacity - 1));
+        size_t first = std::min(size, (size_t)capacity - offset);
+        std::memcpy(bytes, ring + offset, first);
+        std::memcpy(bytes + first, ring, size - first);
+    }
+
+#ifdef _WIN32
+    std::string RegionName(const std::string& name) { return "Local\\snek-" + name; }
+#else
+    std::string RegionName(const std::string& name) { return "/snek-" + name; }
+#endif
+}
+
+bool SharedRegion::Create(const std::string& name, size_t regionSize) {
+    Close();
+    std::string path = RegionName(name);
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        (DWORD)((uint64_t)regionSize >> 32), (DWORD)regionSize, path.c_str());
+    if (!mapping) {
+        return false;
+    }
+    // Another game is already publishing under this name
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        CloseHandle(mapping);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, regionSize);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mappingHandle = mapping;
+#else
+    // A stream left behind by a game that crashed; readers still on it keep their mapping
+    shm_unlink(path.c_str());
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    void* view = MAP_FAILED;
+    if (ftruncate(fd, (off_t)regionSize) == 0) {
+        view = mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (view == MAP_FAILED) {
+        shm_unlink(path.c_str());
+        return false;
+    }
+    ownedName = path;
+#endif
+    data = (uint8_t*)view;
+    size = regionSize;
+    return true;
+}
+
+bool SharedRegion::Open(const std::string& name) {
+    Close();
+    std::string path = RegionName(name);
+#ifdef _WIN32
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, path.c_str());
+    if (!mapping) {
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (!view || VirtualQuery(view, &info, sizeof(info)) == 0) {
+        if (view) {
+            UnmapViewOfFile(view);
+        }
+        CloseHandle(mapping);
+        return false;
+    }
+    mappingHandle = mapping;
+    data = (uint8_t*)view;
+    size = (size_t)info.RegionSize;
+#else
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    data = (uint8_t*)view;
+    size = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+void SharedRegion::Close() {
+    if (!data) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mappingHandle);
+    mappingHandle = nullptr;
+#else
+    munmap(data, size);
+    if (!ownedName.empty()) {
+        shm_unlink(ownedName.c_str());
+        ownedName.clear();
+    }
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+bool SpectatorWriter::Open(const std::string& name, int boardWidth, int boardHeight) {
+    Close();
+    // A keyframe must fit in a quarter of the ring, so a reader that starts
+    // from the newest one has time to copy it
+    size_t cells = std::min((size_t)boardWidth * (size_t)boardHeight, (size_t)1 << 16);
+    size_t keyframeSize = sizeof(RecordHeader) + cells * (sizeof(StreamCell) + sizeof(StreamApple));
+    size_t ringSize = MIN_CAPACITY;
+    while (ringSize < 4 * keyframeSize) {
+        ringSize <<= 1;
+    }
+    if (!region.Create(name, RING_OFFSET + ringSize)) {
+        return false;
+    }
+
+    StreamHeader* header = new (region.Data()) StreamHeader();
+    header->version = VERSION;
+    header->capacity = ringSize;
+    header->magic.store(MAGIC, std::memory_order_release);
+
+    ring = region.Data() + RING_OFFSET;
+    capacity = ringSize;
+    position = 0;
+    lastKeyframe = 0;
+    needKeyframe = true;
+    dropped = 0;
+    return true;
+}
+
+void SpectatorWriter::Close() {
+    if (!ring) {
+        return;
+    }
+    reinterpret_cast<StreamHeader*>(region.Data())->closed.store(1, std::memory_order_release);
+    ring = nullptr;
+    region.Close();
+}
+
+void SpectatorWriter::Publish(const GameState& state) {
+    if (!ring) {
+        return;
+    }
+
+    // A tick record carries the board changes the journal holds since the
+    // last record; anything the journal can't describe gets a keyframe, as
+    // does a tick that changed more than a keyframe would hold
+    const BoardJournal* journal = state.journal;
+    uint32_t ops = journal ? journal->Written() - journalRead : 0;
+    bool keyframe = needKeyframe || !journal || journal->Breaks() != journalBreaks || !journal->Holds(journalRead) ||
+                    ops > state.snake.size() + state.apples.size() || position - lastKeyframe >= capacity / 4;
+
+    RecordHeader fields = {};
+    fields.type = keyframe ? RECORD_KEYFRAME : RECORD_TICK;
+    fields.gameMode = (uint8_t)state.gameMode;
+    fields.tick = state.tick;
+    fields.gameTicks = state.gameTicks;
+    fields.score = state.score;
+    fields.highScore = state.GetCurrentHighScore();
+    fields.boardWidth = (uint16_t)state.boardWidth;
+    fields.boardHeight = (uint16_t)state.boardHeight;
+    fields.deathCause = (uint8_t)state.deathCause;
+    fields.flags = (state.gameOver ? FLAG_GAME_OVER : 0) | (state.isPaused ? FLAG_PAUSED : 0) |
+                   (state.isUserPaused ? FLAG_USER_PAUSED : 0) | (state.isResuming ? FLAG_RESUMING : 0) |
+                   (state.canIntersectSelf ? FLAG_CAN_INTERSECT_SELF : 0) |
+                   (state.canPassWalls ? FLAG_CAN_PASS_WALLS : 0) |
+                   (state.cannotEatApples ? FLAG_CANNOT_EAT_APPLES : 0);
+    for (int kind = 0; kind < TIMER_KIND_COUNT; kind++) {
+        fields.ticksLeft[kind] = state.TicksLeft((TimerKind)kind);
+    }
+
+    record.assign(sizeof(RecordHeader), 0);
+    if (keyframe) {
+        fields.cells = (uint32_t)state.snake.size();
+        for (const Position& cell : state.snake) {
+            AppendCell(record, cell);
+        }
+        fields.apples = (uint32_t)state.apples.size();
+        for (const Apple& apple : state.apples) {
+            StreamApple packed = {};
+            packed.col = (int16_t)apple.col;
+            packed.row = (int16_t)apple.row;
+            packed.type = (uint8_t)apple.type;
+            packed.spawnTick = apple.spawnTick;
+            packed.lifetime = apple.lifetime;
+            Append(record, packed);
+        }
+    } else {
+        fields.ops = ops;
+        for (uint32_t n = journalRead; n != journal->Written(); n++) {
+            const BoardOp& op = journal->At(n);
+            StreamOp packed = {};
+            packed.type = (uint8_t)op.type;
+            packed.food = (uint8_t)op.food;
+            packed.index = op.index;
+            packed.col = (int16_t)op.pos.col;
+            packed.row = (int16_t)op.pos.row;
+            packed.spawnTick = op.spawnTick;
+            packed.lifetime = op.lifetime;
+            Append(record, packed);
+        }
+    }
+    record.resize((record.size() + 7) & ~(size_t)7, 0);
+    fields.size = (uint32_t)record.size();
+    std::memcpy(record.data(), &fields, sizeof(fields));
+
+    if (record.size() > capacity / 4) {
+        dropped++;
+        needKeyframe = true;
+        return;
+    }
+    Write(keyframe);
+    needKeyframe = false;
+    if (journal) {
+        journalRead = journal->Written();
+        journalBreaks = journal->Breaks();
+    }
+}
+
+void SpectatorWriter::Write(bool keyframe) {
+    StreamHeader* header = reinterpret_cast<StreamHeader*>(region.Data());
+    uint64_t start = position;
+    uint64_t end = start + record.size();
+
+    // Claim the bytes before changing them (the seqlock pattern), so a reader
+    // that copied old bytes from here sees the claim when it checks afterwards
+    header->reserved.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    CopyIn(ring, capacity, start, record.data(), record.size());
+    header->published.store(end, std::memory_order_release);
+    if (keyframe) {
+        header->keyframe.store(start, std::memory_order_release);
+        lastKeyframe = start;
+    }
+    position = end;
+}
+
+bool SpectatorReader::Attach(const std::string& name) {
+    Detach();
+    if (!region.Open(name)) {
+        return false;
+    }
+    const StreamHeader* header = reinterpret_cast<const StreamHeader*>(region.Data());
+    if (region.Size() < RING_OFFSET || header->magic.load(std::memory_order_acquire) != MAGIC ||
+        header->version != SpectatorWriter::VERSION || header->capacity > region.Size() - RING_OFFSET) {
+        region.Close();
+        return false;
+    }
+    ring = region.Data() + RING_OFFSET;
+    capacity = header->capacity;
+    position = 0;
+    synced = false;
+    overruns = 0;
+    return true;
+}
+
+void SpectatorReader::Detach() {
+    ring = nullptr;
+    synced = false;
+    region.Close();
+}
+
+bool SpectatorReader::WriterClosed() const {
+    return ring && reinterpret_cast<const StreamHeader*>(region.Data())->closed.load(std::memory_order_acquire);
+}
+
+int SpectatorReader::Poll(GameState& view) {
+    if (!ring) {
+        return 0;
+    }
+    const StreamHeader* header = reinterpret_cast<const StreamHeader*>(region.Data());
+    uint64_t published = header->published.load(std::memory_order_acquire);
+    bool lost = synced && published - position > capacity;
+    int applied = 0;
+
+    // Start (again) from the newest keyframe when not synced; a few tries in
+    // case the writer laps us while we copy that too
+    for (int attempt = 0; attempt < 4; attempt++) {
+        if (!synced || lost) {
+            if (lost) {
+                overruns++;
+            }
+            synced = false;
+            lost = false;
+            position = header->keyframe.load(std::memory_order_acquire);
+            published = header->published.load(std::memory_order_acquire);
+        }
+        while (position < published) {
+            RecordHeader fields;
+            CopyOut(ring, capacity, position, &fields, sizeof(fields));
+            bool valid = fields.size >= sizeof(fields) && fields.size % 8 == 0 && fields.size <= published - position;
+            if (valid) {
+                record.resize(fields.size);
+                CopyOut(ring, capacity, position, record.data(), fields.size);
+            }
+            // The copy may be torn if the writer claimed these bytes meanwhile
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!valid || header->reserved.load(std::memory_order_relaxed) - position > capacity) {
+                lost = true;
+                break;
+            }
+            if (Apply(view)) {
+                applied++;
+            }
+            position += fields.size;
+        }
+        if (!lost) {
+            break;
+        }
+    }
+    return applied;
+}
+
+bool SpectatorReader::Apply(GameState& view) {
+    RecordHeader fields;
+    std::memcpy(&fields, record.data(), sizeof(fields));
+    size_t cellBytes = (size_t)fields.cells * sizeof(StreamCell);
+    size_t appleBytes = (size_t)fields.apples * sizeof(StreamApple);
+    size_t opBytes = (size_t)fields.ops * sizeof(StreamOp);
+    if (sizeof(fields) + cellBytes + appleBytes + opBytes > record.size()) {
+        return false;
+    }
+    const uint8_t* cells = record.data() + sizeof(fields);
+    const uint8_t* apples = cells + cellBytes;
+    const uint8_t* ops = apples + appleBytes;
+
+    if (fields.type == RECORD_KEYFRAME) {
+        view.SetBoardSize(fields.boardWidth, fields.boardHeight);
+        view.ClearBoard();
+        for (uint32_t i = 0; i < fields.cells; i++) {
+            StreamCell cell;
+            std::memcpy(&cell, cells + i * sizeof(StreamCell), sizeof(cell));
+            view.PushTail({cell.col, cell.row});
+        }
+        for (uint32_t i = 0; i < fields.apples; i++) {
+            StreamApple packed;
+            std::memcpy(&packed, apples + i * sizeof(StreamApple), sizeof(packed));
+            Apple apple = {packed.col, packed.row, (FoodType)packed.type, packed.spawnTick, packed.lifetime};
+            view.AddApple(apple);
+        }
+        synced = true;
+    } else if (fields.type == RECORD_TICK && synced) {
+        // The same changes through the same helpers leave the same snake,
+        // apples (in order) and occupancy grid
+        for (uint32_t i = 0; i < fields.ops; i++) {
+            StreamOp packed;
+            std::memcpy(&packed, ops + i * sizeof(StreamOp), sizeof(packed));
+            BoardOp op = {(BoardOp::Type)packed.type, (FoodType)packed.food, packed.index, {packed.col, packed.row},
+                          packed.spawnTick, packed.lifetime};
+            bool pops = op.type == BoardOp::POP_HEAD || op.type == BoardOp::POP_TAIL;
+            if ((pops && view.snake.empty()) ||
+                (op.type == BoardOp::REMOVE_APPLE && (op.index < 0 || op.index >= (int)view.apples.size()))) {
+                synced = false;
+                return false;
+            }
+            view.Replay(op);
+        }
+    } else {
+        return false;
+    }
+
+    view.showModeSelection = false;
+    view.showInstructions = false;
+    view.gameMode = (GameMode)fields.gameMode;
+    view.tick = fields.tick;
+    view.gameTicks = fields.gameTicks;
+    view.score = fields.score;
+    if (view.gameMode == MODE_ACCELERATED) {
+        view.highScoreAccelerated = fields.highScore;
+    } else {
+        view.highScoreRegular = fields.highScore;
+    }
+    view.deathCause = (DeathCause)fields.deathCause;
+    view.gameOver = (fields.flags & FLAG_GAME_OVER) != 0;
+    view.isPaused = (fields.flags & FLAG_PAUSED) != 0;
+    view.isUserPaused = (fields.flags & FLAG_USER_PAUSED) != 0;
+    view.isResuming = (fields.flags & FLAG_RESUMING) != 0;
+    view.canIntersectSelf = (fields.flags & FLAG_CAN_INTERSECT_SELF) != 0;
+    view.canPassWalls = (fields.flags & FLAG_CAN_PASS_WALLS) != 0;
+    view.cannotEatApples = (fields.flags & FLAG_CANNOT_EAT_APPLES) != 0;
+    view.RestoreTimers(fields.ticksLeft);
+    return true;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "game_state.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A named block of shared memory: shm_open on POSIX, a pagefile-backed
+// file mapping on Windows. The creator owns the name and removes it on Close.
+class SharedRegion {
+public:
+    SharedRegion() = default;
+    ~SharedRegion() { Close(); }
+    SharedRegion(const SharedRegion&) = delete;
+    SharedRegion& operator=(const SharedRegion&) = delete;
+
+    // Create the region read-write, replacing any stale one of the same name
+    bool Create(const std::string& name, size_t size);
+    // Map an existing region read-only
+    bool Open(const std::string& name);
+    void Close();
+
+    uint8_t* Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* mappingHandle = nullptr;
+#else
+    std::string ownedName;          // Unlinked on Close when we created it
+#endif
+};
+
+// Live mirror of a running game for spectator screens and analysis tools in
+// other processes. The game publishes one record per tick into a byte ring in
+// shared memory: the status (score, mode, flags, effect timers) and the board
+// changes the state's journal recorded since the last record, which readers
+// replay through the same GameState helpers. Whenever the journal can't
+// describe a tick (a new game, a teleport, a rewind, no journal attached) or
+// the ring has moved a quarter of the way on since the last one, a keyframe
+// with the whole board is written instead.
+//
+// There is one writer and any number of readers, and the writer never waits
+// for them: it bumps `reserved` before overwriting ring bytes and `published`
+// after, so a reader that copied a record then finds `reserved` more than a
+// ring's length past it knows the copy may be torn, counts an overrun and
+// starts again from the newest keyframe.
+class SpectatorWriter {
+public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr size_t MIN_CAPACITY = 1 << 20;
+
+    SpectatorWriter() = default;
+    ~SpectatorWriter() { Close(); }
+    SpectatorWriter(const SpectatorWriter&) = delete;
+    SpectatorWriter& operator=(const SpectatorWriter&) = delete;
+
+    // Create the stream `name`; the ring is sized for keyframes of the given board
+    bool Open(const std::string& name, int boardWidth, int boardHeight);
+    // Tells readers the game is gone and removes the name
+    void Close();
+    bool IsOpen() const { return ring != nullptr; }
+
+    // Call after each GameLogic::Step (or anything else that changed the
+    // state). Tick records are built from state.journal, so keep one
+    // attached (the rewind buffer's does); without it every record is a keyframe.
+    void Publish(const GameState& state);
+
+    uint64_t BytesWritten() const { return position; }
+    // Records too big for the ring (keyframes of huge snakes on huge boards)
+    uint32_t Dropped() const { return dropped; }
+
+private:
+    void Write(bool keyframe);
+
+    SharedRegion region;
+    uint8_t* ring = nullptr;
+    uint64_t capacity = 0;
+    uint64_t position = 0;          // Ring bytes written so far
+    uint64_t lastKeyframe = 0;
+    bool needKeyframe = true;
+    uint32_t dropped = 0;
+    uint32_t journalRead = 0;       // Journal ops up to here are in the published records
+    uint32_t journalBreaks = 0;     // The journal's Breaks() then
+    std::vector<uint8_t> record;
+};
+
+class SpectatorReader {
+public:
+    SpectatorReader() = default;
+    SpectatorReader(const SpectatorReader&) = delete;
+    SpectatorReader& operator=(const SpectatorReader&) = delete;
+
+    // Returns false if no game is publishing under `name` yet
+    bool Attach(const std::string& name);
+    void Detach();
+    bool IsAttached() const { return ring != nullptr; }
+    // The game closed the stream; Detach and Attach again to follow the next one
+    bool WriterClosed() const;
+
+    // Bring `view` up to date with everything published since the last call
+    // and return the number of records applied. `view` should only be
+    // changed by Poll; its snake, apples, status and effect timers follow
+    // the game once Synced.
+    int Poll(GameState& view);
+
+    bool Synced() const { return synced; }
+    uint32_t Overruns() const { return overruns; }
+
+private:
+    bool Apply(GameState& view);
+
+    SharedRegion region;
+    const uint8_t* ring = nullptr;
+    uint64_t capacity = 0;
+    uint64_t position = 0;
+    bool synced = false;
+    uint32_t overruns = 0;
+    std::vector<uint8_t> record;
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Refers to one scheduled event; stays safe to use after the event fired or
+// was cancelled (the generation no longer matches)
+struct TimerHandle {
+    int32_t index = -1;
+    uint32_t generation = 0;
+};
+
+// Hashed timer wheel keyed by tick. Events live in a pooled node array and
+// are linked into the slot for their due tick modulo SLOT_COUNT, so
+// scheduling and cancelling are O(1) and Advance only walks the one slot
+// for the tick (events a whole turn of the wheel or more away just stay
+// put). Plain indices instead of pointers, so the wheel copies with the
+// state that owns it (replay keyframes).
+class TimerWheel {
+public:
+    static constexpr int SLOT_COUNT = 256;  // Power of two; about 4 s at 60 ticks per second
+
+    struct Event {
+        uint32_t due;
+        int kind;           // Meaning is up to the owner
+        uint32_t payload;
+    };
+
+    TimerWheel() { Clear(0); }
+
+    // Drop every event; `now` is the tick the wheel has reached
+    void Clear(uint32_t now) {
+        for (int32_t& head : slots_) {
+            head = NONE;
+        }
+        for (Node& node : nodes_) {
+            node.generation++;
+            node.live = false;
+        }
+        free_.clear();
+        for (int32_t i = (int32_t)nodes_.size() - 1; i >= 0; i--) {
+            free_.push_back(i);
+        }
+        now_ = now;
+        size_ = 0;
+    }
+
+    // Fire `kind` at tick `due`; events due now or earlier fire on the next tick
+    TimerHandle Schedule(uint32_t due, int kind, uint32_t payload = 0) {
+        if ((int32_t)(due - now_) <= 0) {
+            due = now_ + 1;
+        }
+        int32_t index;
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        } else {
+            index = (int32_t)nodes_.size();
+            nodes_.emplace_back();
+        }
+        Node& node = nodes_[index];
+        node.due = due;
+        node.kind = kind;
+        node.payload = payload;
+        node.sequence = nextSequence_++;
+        node.live = true;
+        Link(index);
+        size_++;
+        return {index, node.generation};
+    }
+
+    // Returns false if the event already fired or was cancelled
+    bool Cancel(TimerHandle& handle) {
+        bool pending = Pending(handle);
+        if (pending) {
+            Unlink(handle.index);
+            Release(handle.index);
+        }
+        handle = TimerHandle();
+        return pending;
+    }
+
+    bool Pending(TimerHandle handle) const {
+        return handle.index >= 0 && handle.index < (int32_t)nodes_.size() &&
+               nodes_[handle.index].live && nodes_[handle.index].generation == handle.generation;
+    }
+
+    // Ticks until the event fires, or 0 if it is not pending
+    int TicksLeft(TimerHandle handle) const {
+        return Pending(handle) ? (int)(nodes_[handle.index].due - now_) : 0;
+    }
+
+    // Move to tick `now`, appending the events that came due to `fired`
+    // ordered by due tick, then kind, then when they were scheduled. Ticks
+    // skipped since the last call are visited in turn.
+    void Advance(uint32_t now, std::vector<Event>& fired) {
+        size_t first = fired.size();
+        while (now_ != now) {
+            now_++;
+            if (size_ == 0) {
+                now_ = now;
+                break;
+            }
+            int32_t index = slots_[now_ & (SLOT_COUNT - 1)];
+            while (index != NONE) {
+                int32_t next = nodes_[index].next;
+                if (nodes_[index].due == now_) {
+                    Unlink(index);
+                    InsertSorted(fired, first, index);
+                    Release(index);
+                }
+                index = next;
+            }
+        }
+        sequences_.clear();
+    }
+
+    uint32_t Now() const { return now_; }
+    int Size() const { return size_; }
+
+private:
+    static constexpr int32_t NONE = -1;
+
+    struct Node {
+        uint32_t due = 0;
+        int kind = 0;
+        uint32_t payload = 0;
+        uint32_t sequence = 0;
+        uint32_t generation = 0;
+        int32_t prev = NONE;
+        int32_t next = NONE;
+        bool live = false;
+    };
+
+    void Link(int32_t index) {
+        Node& node = nodes_[index];
+        int32_t& head = slots_[node.due & (SLOT_COUNT - 1)];
+        node.prev = NONE;
+        node.next = head;
+        if (head != NONE) {
+            nodes_[head].prev = index;
+        }
+        head = index;
+    }
+
+    void Unlink(int32_t index) {
+        Node& node = nodes_[index];
+        if (node.prev != NONE) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            slots_[node.due & (SLOT_COUNT - 1)] = node.next;
+        }
+        if (node.next != NONE) {
+            nodes_[node.next].prev = node.prev;
+        }
+    }
+
+    void Release(int32_t index) {
+        nodes_[index].live = false;
+        nodes_[index].generation++;
+        free_.push_back(index);
+        size_--;
+    }
+
+    // Insertion sort on (due, kind, sequence); only a few events come due per tick
+    void InsertSorted(std::vector<Event>& fired, size_t first, int32_t index) {
+        const Node& node = nodes_[index];
+        size_t at = fired.size();
+        fired.push_back({node.due, node.kind, node.payload});
+        sequences_.push_back(node.sequence);
+        while (at > first) {
+            size_t prev = at - 1;
+            const Event& before = fired[prev];
+            if (before.due != node.due ? before.due < node.due :
+                before.kind != node.kind ? before.kind < node.kind :
+                sequences_[prev - first] < node.sequence) {
+                break;
+            }
+            fired[at] = fired[prev];
+            sequences_[at - first] = sequences_[prev - first];
+            at = prev;
+        }
+        fired[at] = {node.due, node.kind, node.payload};
+        sequences_[at - first] = node.sequence;
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<int32_t> free_;
+    std::vector<uint32_t> sequences_;   // Scratch for Advance, parallel to its slice of `fired`
+    int32_t slots_[SLOT_COUNT];
+    uint32_t now_ = 0;
+    uint32_t nextSequence_ = 0;
+    int size_ = 0;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads for data-parallel loops. ParallelFor splits a range
+// into one contiguous chunk per thread (the caller runs the first chunk) and
+// returns once every chunk is done, so jobs that only write their own
+// elements need no further synchronization.
+class WorkerPool {
+public:
+    explicit WorkerPool(int threads = 0) {
+        if (threads <= 0) {
+            threads = (int)std::thread::hardware_concurrency();
+        }
+        threadCount = threads > 0 ? threads : 1;
+        for (int i = 1; i < threadCount; i++) {
+            workers.emplace_back([this, i]() { WorkerLoop(i); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            generation++;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int Size() const { return threadCount; }
+
+    // Calls job(begin, end) on disjoint chunks covering [0, count)
+    void ParallelFor(int count, const std::function<void(int, int)>& job) {
+        if (threadCount == 1 || count < threadCount) {
+            if (count > 0) {
+                job(0, count);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            currentJob = &job;
+            jobCount = count;
+            pending = threadCount - 1;
+            generation++;
+        }
+        wake.notify_all();
+        RunChunk(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return pending == 0; });
+        currentJob = nullptr;
+    }
+
+private:
+    void RunChunk(int index) {
+        int begin = (int)((long long)jobCount * index / threadCount);
+        int end = (int)((long long)jobCount * (index + 1) / threadCount);
+        if (begin < end) {
+            (*currentJob)(begin, end);
+        }
+    }
+
+    void WorkerLoop(int index) {
+        unsigned long long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return generation != seen; });
+                seen = generation;
+                if (stopping) {
+                    return;
+                }
+            }
+            RunChunk(index);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending--;
+            }
+            done.notify_one();
+        }
+    }
+
+    int threadCount = 1;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned long long generation = 0;
+    const std::function<void(int, int)>* currentJob = nullptr;
+    int jobCount = 0;
+    int pending = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,100 @@
+// Headless arena stress run: steps an all-bot arena for a fixed number of
+// moves and prints throughput, survivors, deaths and the final state hash.
+// With --verify the same run is repeated on one thread and the hashes must
+// match, which checks that the parallel update is deterministic.
+//
+// Usage: snake_arena [--snakes <n>] [--board <cols>x<rows>] [--ticks <n>]
+//                    [--threads <n>] [--seed <n>] [--apples <n>] [--verify 1]
+
+#include "arena.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    struct RunResult {
+        double seconds;
+        uint64_t snakeMoves;
+        uint64_t hash;
+    };
+
+    RunResult Run(Arena& arena, const ArenaConfig& config, int ticks) {
+        arena.Initialize(config);
+        uint64_t snakeMoves = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; i++) {
+            snakeMoves += arena.AliveCount();
+            arena.Step();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return {seconds, snakeMoves, arena.Hash()};
+    }
+}
+
+int main(int argc, char** argv) {
+    ArenaConfig config;
+    config.player = false;
+    int ticks = 1000;
+    bool verify = false;
+    // Every option takes a value
+    for (int i = 1; i < argc; i += 2) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = true;
+        if (!value) {
+            ok = false;
+        } else if (std::strcmp(arg, "--snakes") == 0) {
+            config.snakes = std::max(1, std::atoi(value));
+        } else if (std::strcmp(arg, "--board") == 0) {
+            char* end = nullptr;
+            config.width = (int)std::strtol(value, &end, 10);
+            config.height = (*end == 'x') ? (int)std::strtol(end + 1, nullptr, 10) : config.width;
+        } else if (std::strcmp(arg, "--ticks") == 0) {
+            ticks = std::max(1, std::atoi(value));
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            config.threads = std::max(0, std::atoi(value));
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--apples") == 0) {
+            config.apples = std::max(0, std::atoi(value));
+        } else if (std::strcmp(arg, "--verify") == 0) {
+            verify = std::atoi(value) != 0;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "Bad or unknown option %s (see the usage at the top of snake_arena.cpp)\n", arg);
+            return 1;
+        }
+    }
+
+    Arena arena;
+    RunResult result = Run(arena, config, ticks);
+    int longest = 0;
+    for (const ArenaSnake& snake : arena.Snakes()) {
+        longest = std::max(longest, snake.body.size());
+    }
+
+    std::printf("board %dx%d, %d snakes, %d apples, %d threads\n", arena.Width(), arena.Height(),
+                (int)arena.Snakes().size(), (int)arena.Apples().size(), arena.Threads());
+    std::printf("%d ticks in %.3f s: %.0f ticks/s, %.0f snake moves/s\n", ticks, result.seconds,
+                ticks / result.seconds, result.snakeMoves / result.seconds);
+    std::printf("alive %d, longest %d, deaths: wall %llu, body %llu, head-on %llu\n", arena.AliveCount(), longest,
+                (unsigned long long)arena.wallDeaths, (unsigned long long)arena.bodyDeaths,
+                (unsigned long long)arena.headOnDeaths);
+    std::printf("hash %016llx\n", (unsigned long long)result.hash);
+
+    if (verify) {
+        ArenaConfig serial = config;
+        serial.threads = 1;
+        Arena reference;
+        RunResult check = Run(reference, serial, ticks);
+        bool same = check.hash == result.hash;
+        std::printf("1 thread: hash %016llx in %.3f s (%s)\n", (unsigned long long)check.hash, check.seconds,
+                    same ? "match" : "MISMATCH");
+        return same ? 0 : 1;
+    }
+    return 0;
+}
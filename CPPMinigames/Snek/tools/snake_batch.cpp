@@ -0,0 +1,234 @@
+// Lockstep batch throughput: plays thousands of games with random actions
+// through BatchEngine and through the same number of GameStates stepped one
+// move at a time (as snake_env does), and prints moves per second for both.
+// Games that end start over with the next seed. With --verify both run side
+// by side and every game is compared after every step, snake and apples
+// included; the first difference is printed and the exit code is 1.
+//
+// Usage: snake_batch [--games <n>] [--steps <n>] [--board <cols>x<rows>]
+//                    [--mode regular|accelerated] [--seed <n>] [--verify]
+
+#include "batch_engine.h"
+#include "game_logic.h"
+#include "game_state.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+    const int MAX_TICKS_PER_STEP = 10 * GameConstants::TICK_RATE;
+    const Direction ACTIONS[BatchEngine::ACTION_COUNT] = {{0, 0}, {0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+
+    struct Options {
+        int games = 4096;
+        int steps = 500;
+        int boardWidth = GameConstants::GRID_WIDTH;
+        int boardHeight = GameConstants::GRID_HEIGHT;
+        GameMode mode = MODE_REGULAR;
+        uint64_t seed = 1;
+        bool verify = false;
+    };
+
+    // Seed of a game's n-th episode, the same for both runners
+    uint64_t EpisodeSeed(const Options& options, int game, int episode) {
+        return options.seed * 0x9E3779B97F4A7C15ull + (uint64_t)game * 0x10000 + (uint64_t)episode;
+    }
+
+    // Mostly straight on, sometimes a turn; drawn up front so both runners see the same actions
+    std::vector<uint8_t> MakeActions(const Options& options) {
+        std::vector<uint8_t> actions((size_t)options.games * options.steps);
+        Rng rng(options.seed);
+        for (uint8_t& action : actions) {
+            int roll = rng.Range(0, 7);
+            action = (roll < 4) ? (uint8_t)(roll + 1) : 0;
+        }
+        return actions;
+    }
+
+    class StateRunner {
+    public:
+        void Initialize(const Options& options) {
+            states.resize(options.games);
+            episodes.assign(options.games, 0);
+            for (int game = 0; game < options.games; game++) {
+                GameState& state = states[game];
+                state.SetBoardSize(options.boardWidth, options.boardHeight);
+                state.Initialize(0);
+                state.gameMode = options.mode;
+                state.Reset(EpisodeSeed(options, game, 0));
+            }
+        }
+
+        void Step(const Options& options, const uint8_t* actions) {
+            for (int game = 0; game < options.games; game++) {
+                GameState& state = states[game];
+                if (actions[game] != 0) {
+                    GameLogic::QueueDirection(state, ACTIONS[actions[game]]);
+                }
+                GameLogic::StepToMove(state, MAX_TICKS_PER_STEP);
+                state.events.Clear();
+            }
+        }
+
+        void Restart(const Options& options) {
+            for (int game = 0; game < options.games; game++) {
+                if (states[game].gameOver) {
+                    states[game].Reset(EpisodeSeed(options, game, ++episodes[game]));
+                }
+            }
+        }
+
+        std::vector<GameState> states;
+        std::vector<int> episodes;
+    };
+
+    class BatchRunner {
+    public:
+        void Initialize(const Options& options) {
+            BatchEngine::Config config;
+            config.games = options.games;
+            config.boardWidth = options.boardWidth;
+            config.boardHeight = options.boardHeight;
+            config.mode = options.mode;
+            engine.Initialize(config);
+            episodes.assign(options.games, 0);
+            for (int game = 0; game < options.games; game++) {
+                engine.Reset(game, EpisodeSeed(options, game, 0));
+            }
+        }
+
+        void Restart(const Options& options) {
+            for (int game = 0; game < options.games; game++) {
+                if (engine.GameOver(game)) {
+                    engine.Reset(game, EpisodeSeed(options, game, ++episodes[game]));
+                }
+            }
+        }
+
+        BatchEngine engine;
+        std::vector<int> episodes;
+    };
+
+    // Empty if game `game` is the same in both, else what differs first
+    const char* Compare(const GameState& state, const BatchEngine& engine, int game) {
+        if (state.gameOver != engine.GameOver(game) || state.deathCause != engine.GetDeathCause(game)) {
+            return "game over";
+        }
+        if (state.tick != engine.Tick(game) || state.score != engine.Score(game)) {
+            return "tick or score";
+        }
+        if (state.dx != engine.Heading(game).dx || state.dy != engine.Heading(game).dy) {
+            return "heading";
+        }
+        if (state.snake.size() != engine.Length(game)) {
+            return "length";
+        }
+        for (int i = 0; i < state.snake.size(); i++) {
+            Position segment = engine.Segment(game, i);
+            if (state.snake[i].col != segment.col || state.snake[i].row != segment.row) {
+                return "snake";
+            }
+        }
+        if ((int)state.apples.size() != engine.AppleCount(game)) {
+            return "apple count";
+        }
+        for (int i = 0; i < (int)state.apples.size(); i++) {
+            Apple apple = engine.GetApple(game, i);
+            const Apple& expected = state.apples[i];
+            if (expected.col != apple.col || expected.row != apple.row || expected.type != apple.type ||
+                expected.spawnTick != apple.spawnTick || expected.lifetime != apple.lifetime) {
+                return "apples";
+            }
+        }
+        return "";
+    }
+
+    int Verify(const Options& options, const std::vector<uint8_t>& actions) {
+        StateRunner states;
+        BatchRunner batch;
+        states.Initialize(options);
+        batch.Initialize(options);
+        long long episodes = 0;
+        for (int step = 0; step < options.steps; step++) {
+            const uint8_t* stepActions = actions.data() + (size_t)step * options.games;
+            states.Step(options, stepActions);
+            batch.engine.Step(stepActions);
+            for (int game = 0; game < options.games; game++) {
+                const char* difference = Compare(states.states[game], batch.engine, game);
+                if (difference[0] != '\0') {
+                    std::printf("step %d, game %d (episode %d): %s differs\n", step, game, states.episodes[game],
+                                difference);
+                    return 1;
+                }
+                episodes += states.states[game].gameOver ? 1 : 0;
+            }
+            states.Restart(options);
+            batch.Restart(options);
+        }
+        std::printf("verified %d games x %d steps (%lld episodes ended): identical\n", options.games, options.steps,
+                    episodes);
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            options.games = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            options.steps = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--board") == 0 && i + 1 < argc) {
+            char* end = nullptr;
+            options.boardWidth = (int)std::strtol(argv[++i], &end, 10);
+            options.boardHeight = (*end == 'x') ? (int)std::strtol(end + 1, nullptr, 10) : options.boardWidth;
+        } else if (std::strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            options.mode = (std::strcmp(argv[++i], "accelerated") == 0) ? MODE_ACCELERATED : MODE_REGULAR;
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--verify") == 0) {
+            options.verify = true;
+        } else {
+            std::fprintf(stderr, "Usage: %s [--games <n>] [--steps <n>] [--board <cols>x<rows>]\n"
+                                 "       [--mode regular|accelerated] [--seed <n>] [--verify]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> actions = MakeActions(options);
+    if (options.verify) {
+        return Verify(options, actions);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    StateRunner states;
+    states.Initialize(options);
+    Clock::time_point start = Clock::now();
+    for (int step = 0; step < options.steps; step++) {
+        states.Step(options, actions.data() + (size_t)step * options.games);
+        states.Restart(options);
+    }
+    double stateSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    BatchRunner batch;
+    batch.Initialize(options);
+    start = Clock::now();
+    for (int step = 0; step < options.steps; step++) {
+        batch.engine.Step(actions.data() + (size_t)step * options.games);
+        batch.Restart(options);
+    }
+    double batchSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    double moves = (double)options.games * options.steps;
+    std::printf("games:         %d (%dx%d, %s)\n", options.games, batch.engine.BoardWidth(), batch.engine.BoardHeight(),
+                options.mode == MODE_ACCELERATED ? "accelerated" : "regular");
+    std::printf("steps:         %d\n", options.steps);
+    std::printf("GameState:     %.0f moves/s\n", stateSeconds > 0.0 ? moves / stateSeconds : 0.0);
+    std::printf("BatchEngine:   %.0f moves/s\n", batchSeconds > 0.0 ? moves / batchSeconds : 0.0);
+    std::printf("speedup:       %.1fx\n", batchSeconds > 0.0 ? stateSeconds / batchSeconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,85 @@
+/* Plays random-action episodes through the snake_env C API and prints the
+ * steps per second, episodes and mean score. Also serves as a minimal
+ * example of driving the environment.
+ *
+ * Usage: snake_env_run [--steps <n>] [--board <cols>x<rows>] [--mode regular|accelerated]
+ *                      [--seed <n>]
+ */
+
+#include "snake_env.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t NextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+int main(int argc, char** argv) {
+    SnakeEnvConfig config;
+    long long steps = 1000000;
+    uint64_t seed = 1;
+    snake_env_default_config(&config);
+    config.max_steps = 5000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            steps = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc) {
+            char* end = NULL;
+            config.board_width = (int)strtol(argv[++i], &end, 10);
+            config.board_height = (*end == 'x') ? (int)strtol(end + 1, NULL, 10) : config.board_width;
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            config.mode = (strcmp(argv[++i], "accelerated") == 0) ? SNAKE_ENV_MODE_ACCELERATED : SNAKE_ENV_MODE_REGULAR;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [--steps <n>] [--board <cols>x<rows>] [--mode regular|accelerated] [--seed <n>]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    SnakeEnv* env = snake_env_create(&config);
+    if (!env) {
+        fprintf(stderr, "Could not create the environment\n");
+        return 1;
+    }
+    int width = snake_env_board_width(env);
+    int height = snake_env_board_height(env);
+    uint8_t* planes = (uint8_t*)malloc((size_t)SNAKE_ENV_PLANE_COUNT * width * height);
+    float effects[SNAKE_ENV_EFFECT_COUNT];
+    snake_env_set_buffers(env, planes, effects);
+
+    uint64_t random = seed * 0x9E3779B97F4A7C15ull + 1;
+    long long episodes = 0;
+    long long totalScore = 0;
+    SnakeEnvResult result;
+    snake_env_reset(env, seed);
+    clock_t start = clock();
+    for (long long i = 0; i < steps; i++) {
+        /* Mostly straight on, sometimes a turn */
+        uint64_t roll = NextRandom(&random) % 8;
+        int action = (roll < 4) ? (int)roll + 1 : SNAKE_ENV_ACTION_NONE;
+        snake_env_step(env, action, &result);
+        if (result.terminated || result.truncated) {
+            episodes++;
+            totalScore += result.score;
+            snake_env_reset(env, seed + (uint64_t)episodes);
+        }
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("board:       %dx%d\n", width, height);
+    printf("steps:       %lld\n", steps);
+    printf("episodes:    %lld\n", episodes);
+    printf("mean score:  %.2f\n", episodes > 0 ? (double)totalScore / episodes : 0.0);
+    printf("throughput:  %.0f steps/s\n", seconds > 0.0 ? steps / seconds : 0.0);
+
+    snake_env_destroy(env);
+    free(planes);
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Asset packer: bundles files into one snake.pak archive (see asset_pack.h).
+// Each asset is stored under its file name without the directory, which is
+// the name the game looks it up by. Run by the build; after writing, the
+// pack is reopened and every asset compared against its source file.
+//
+// Usage: snake_pack <output.pak> <file>...
+
+#include "asset_pack.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: snake_pack <output.pak> <file>...\n");
+        return 1;
+    }
+
+    std::vector<AssetPack::Entry> entries;
+    for (int i = 2; i < argc; i++) {
+        std::string path = argv[i];
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "Could not read %s\n", path.c_str());
+            return 1;
+        }
+        AssetPack::Entry entry;
+        size_t lastSlash = path.find_last_of("/\\");
+        entry.name = (lastSlash == std::string::npos) ? path : path.substr(lastSlash + 1);
+        entry.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        for (const AssetPack::Entry& other : entries) {
+            if (other.name == entry.name) {
+                std::fprintf(stderr, "Duplicate asset name %s\n", entry.name.c_str());
+                return 1;
+            }
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    if (!AssetPack::Write(argv[1], entries)) {
+        std::fprintf(stderr, "Could not write %s (asset names must be 1 to %d characters)\n", argv[1],
+                     (int)AssetPack::NAME_SIZE - 1);
+        return 1;
+    }
+
+    AssetPack pack;
+    if (!pack.Open(argv[1])) {
+        std::fprintf(stderr, "Wrote %s but could not reopen it\n", argv[1]);
+        return 1;
+    }
+    size_t total = 0;
+    for (const AssetPack::Entry& entry : entries) {
+        size_t size = 0;
+        const uint8_t* bytes = pack.Find(entry.name.c_str(), size);
+        if (!bytes || size != entry.bytes.size() || std::memcmp(bytes, entry.bytes.data(), size) != 0) {
+            std::fprintf(stderr, "Asset %s did not survive the round trip\n", entry.name.c_str());
+            return 1;
+        }
+        total += size;
+    }
+    std::printf("Packed %d assets (%zu bytes) into %s\n", (int)entries.size(), total, argv[1]);
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Headless replay-to-image renderer: re-simulates a recorded session and
+// draws frames with the game's own Renderer into a CPU framebuffer (see
+// soft_raster.h), so it runs on machines with no GPU or display.
+//
+// A frame is drawn every --every ticks (every tick by default) plus one for
+// the final state, with the game over screen on top if the game ended. With
+// --out each frame is written as <prefix>_<tick>.ppm; --hash prints a hash
+// of each frame for comparing against golden values. Drawing throughput is
+// reported on stderr.
+//
+// Usage: snake_render <replay file> [--every <ticks>] [--out <prefix>] [--hash]
+
+#include "game_colors.h"
+#include "game_state.h"
+#include "renderer.h"
+#include "replay.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+    struct Options {
+        const char* replayPath = nullptr;
+        int every = 1;
+        std::string outPrefix;
+        bool hash = false;
+    };
+
+    void DrawFrame(const GameState& state) {
+        Renderer::DrawGame(state);
+        if (state.gameOver) {
+            Renderer::DrawGameOverScreen(state);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--every") == 0 && i + 1 < argc) {
+            options.every = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            options.outPrefix = argv[++i];
+        } else if (std::strcmp(argv[i], "--hash") == 0) {
+            options.hash = true;
+        } else if (argv[i][0] != '-' && !options.replayPath) {
+            options.replayPath = argv[i];
+        } else {
+            options.replayPath = nullptr;
+            break;
+        }
+    }
+    if (!options.replayPath) {
+        std::fprintf(stderr, "Usage: %s <replay file> [--every <ticks>] [--out <prefix>] [--hash]\n", argv[0]);
+        return 1;
+    }
+
+    Replay replay;
+    if (!replay.LoadFromFile(options.replayPath)) {
+        std::fprintf(stderr, "Could not load replay %s\n", options.replayPath);
+        return 1;
+    }
+
+    SoftCanvas canvas;
+    canvas.Resize(GameConstants::SCREEN_WIDTH, GameConstants::SCREEN_HEIGHT);
+    SetSoftCanvas(&canvas);
+
+    using Clock = std::chrono::steady_clock;
+    GameState state;
+    ReplayPlayer player;
+    player.Start(replay, state);
+    int frames = 0;
+    double drawSeconds = 0.0;
+    auto render = [&]() {
+        Clock::time_point start = Clock::now();
+        DrawFrame(state);
+        drawSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+        frames++;
+
+        if (options.hash) {
+            std::printf("%u %016llx\n", player.CurrentTick(), (unsigned long long)canvas.Hash());
+        }
+        if (!options.outPrefix.empty()) {
+            char suffix[32];
+            std::snprintf(suffix, sizeof(suffix), "_%06u.ppm", player.CurrentTick());
+            if (!canvas.WritePpm(options.outPrefix + suffix)) {
+                std::fprintf(stderr, "Could not write %s%s\n", options.outPrefix.c_str(), suffix);
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Every --every ticks, then the final state with the inputs logged on its tick applied
+    while (!player.Finished()) {
+        if (player.CurrentTick() % options.every == 0 && !render()) {
+            return 1;
+        }
+        player.Step(state);
+        state.events.Clear();
+    }
+    player.Step(state);
+    if (!render()) {
+        return 1;
+    }
+    Renderer::Unload();
+
+    std::fprintf(stderr, "frames:      %d (%dx%d)\n", frames, canvas.Width(), canvas.Height());
+    std::fprintf(stderr, "draw:        %.0f frames/s\n", drawSeconds > 0.0 ? frames / drawSeconds : 0.0);
+    return 0;
+}
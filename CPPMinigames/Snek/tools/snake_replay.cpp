@@ -0,0 +1,55 @@
+// Headless replay runner: re-simulates a recorded session at full speed and
+// reports the outcome and simulation throughput.
+//
+// Usage: snake_replay <file> [--repeat <n>]
+
+#include "game_state.h"
+#include "replay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <replay file> [--repeat <n>]\n", argv[0]);
+        return 1;
+    }
+    
+    int repeat = 1;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::atoi(argv[++i]);
+            if (repeat < 1) repeat = 1;
+        }
+    }
+    
+    Replay replay;
+    if (!replay.LoadFromFile(argv[1])) {
+        std::fprintf(stderr, "Could not load replay %s\n", argv[1]);
+        return 1;
+    }
+    
+    GameState state;
+    ReplayPlayer player;
+    uint64_t totalTicks = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < repeat; run++) {
+        player.Start(replay, state);
+        while (player.Step(state)) {
+        }
+        totalTicks += player.CurrentTick();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::printf("seed:        %llu\n", (unsigned long long)replay.seed);
+    std::printf("mode:        %s\n", replay.mode == MODE_ACCELERATED ? "accelerated" : "regular");
+    std::printf("board:       %dx%d\n", replay.boardWidth, replay.boardHeight);
+    std::printf("ticks:       %u\n", replay.endTick);
+    std::printf("inputs:      %zu\n", replay.events.size());
+    std::printf("final score: %d\n", state.score);
+    std::printf("length:      %d\n", state.snake.size());
+    std::printf("game over:   %s\n", state.gameOver ? "yes" : "no");
+    std::printf("throughput:  %.0f ticks/s\n", seconds > 0.0 ? totalTicks / seconds : 0.0);
+    return 0;
+}
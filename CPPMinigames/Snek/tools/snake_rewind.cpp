@@ -0,0 +1,326 @@
+// Headless rewind run: random play with a RewindBuffer capturing the ticks
+// the game captures (not while paused or over), rewinding now and then and
+// retrying some finished games from further back, and prints what capture
+// and rewind cost. With --verify 1 it also keeps a full copy of the state
+// for every captured tick and checks each rewind against it (snake, apples,
+// occupancy grid and free-cell order, timers, random generator and the
+// rest), then plays on from the restored state and checks the game goes on
+// exactly as it did the first time. After every capture it checks the buffer
+// offers no more ticks than were captured since the game started (less any
+// rewound over). The first difference is printed and the exit code is 1.
+//
+// Usage: snake_rewind [--ticks <n>] [--seed <n>] [--mode regular|accelerated]
+//                     [--board <cols>x<rows>] [--seconds <n>] [--verify 1]
+
+#include "game_logic.h"
+#include "game_state.h"
+#include "rewind_buffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+
+namespace {
+    // Every this many ticks a running game is rewound a random distance
+    const int REWIND_INTERVAL = 997;
+    // Ticks replayed after a rewind to check the game continues as before
+    const int CONTINUE_TICKS = 120;
+
+    struct Options {
+        long long ticks = 400000;
+        uint64_t seed = 1;
+        GameMode mode = MODE_REGULAR;
+        int boardWidth = GameConstants::GRID_WIDTH;
+        int boardHeight = GameConstants::GRID_HEIGHT;
+        int seconds = 10;
+        bool verify = false;
+    };
+
+    // Heads for the first apple by a random safe turn that gets closer (any
+    // safe one otherwise), so the snake grows until it boxes itself in, with
+    // the odd blind turn and the odd short pause. Everything is drawn from
+    // the game's own generator so the choice depends only on the state: a
+    // restored state makes the same choices again.
+    void Drive(GameState& state) {
+        const Direction moves[4] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+        if (state.directionQueue.empty() && !state.snake.empty()) {
+            Position head = state.snake.front();
+            int first = state.RandomInt(0, 3);
+            if (state.RandomInt(0, 300) == 0) {
+                GameLogic::QueueDirection(state, moves[first]);
+            }
+            for (int pass = 0; pass < 2 && state.directionQueue.empty(); pass++) {
+                for (int i = 0; i < 4 && state.directionQueue.empty(); i++) {
+                    Direction move = moves[(first + i) % 4];
+                    int col = head.col + move.dx;
+                    int row = head.row + move.dy;
+                    if (col < 0 || row < 0 || col >= state.boardWidth || row >= state.boardHeight ||
+                        state.grid.HasSnake(col, row)) {
+                        continue;
+                    }
+                    if (pass == 0 && !state.apples.empty()) {
+                        const Apple& apple = state.apples.front();
+                        if (std::abs(apple.col - col) + std::abs(apple.row - row) >=
+                            std::abs(apple.col - head.col) + std::abs(apple.row - head.row)) {
+                            continue;
+                        }
+                    }
+                    GameLogic::QueueDirection(state, move);
+                }
+            }
+        }
+        if (state.RandomInt(0, state.isUserPaused ? 30 : 2000) == 0) {
+            GameLogic::TogglePause(state);
+        }
+    }
+
+    void Advance(GameState& state) {
+        Drive(state);
+        GameLogic::Step(state);
+        state.events.Clear();
+    }
+
+    // Empty if the two states are the same, else what differs first
+    const char* Compare(const GameState& a, const GameState& b) {
+        if (a.tick != b.tick || a.gameTicks != b.gameTicks || a.moveTimer != b.moveTimer) {
+            return "tick counters";
+        }
+        if (!(a.rng == b.rng)) {
+            return "random generator";
+        }
+        if (a.score != b.score || a.highScoreRegular != b.highScoreRegular ||
+            a.highScoreAccelerated != b.highScoreAccelerated) {
+            return "score";
+        }
+        if (a.dx != b.dx || a.dy != b.dy || a.directionQueue.size() != b.directionQueue.size()) {
+            return "heading or queued turns";
+        }
+        for (size_t i = 0; i < a.directionQueue.size(); i++) {
+            if (a.directionQueue[i].dx != b.directionQueue[i].dx || a.directionQueue[i].dy != b.directionQueue[i].dy) {
+                return "queued turns";
+            }
+        }
+        if (a.gameOver != b.gameOver || a.deathCause != b.deathCause || a.isPaused != b.isPaused ||
+            a.isUserPaused != b.isUserPaused || a.isResuming != b.isResuming) {
+            return "game flags";
+        }
+        if (a.canIntersectSelf != b.canIntersectSelf || a.canPassWalls != b.canPassWalls ||
+            a.cannotEatApples != b.cannotEatApples || a.movesSinceTeleport != b.movesSinceTeleport) {
+            return "effects";
+        }
+        for (int kind = 0; kind < TIMER_KIND_COUNT; kind++) {
+            if (a.TicksLeft((TimerKind)kind) != b.TicksLeft((TimerKind)kind)) {
+                return "timers";
+            }
+        }
+        if (a.snake.size() != b.snake.size()) {
+            return "snake length";
+        }
+        for (int i = 0; i < a.snake.size(); i++) {
+            if (a.snake[i].col != b.snake[i].col || a.snake[i].row != b.snake[i].row) {
+                return "snake";
+            }
+        }
+        if (a.apples.size() != b.apples.size()) {
+            return "apple count";
+        }
+        for (size_t i = 0; i < a.apples.size(); i++) {
+            const Apple& x = a.apples[i];
+            const Apple& y = b.apples[i];
+            if (x.col != y.col || x.row != y.row || x.type != y.type || x.spawnTick != y.spawnTick ||
+                x.lifetime != y.lifetime) {
+                return "apples";
+            }
+        }
+        for (int row = 0; row < a.boardHeight; row++) {
+            for (int col = 0; col < a.boardWidth; col++) {
+                if (a.grid.HasSnake(col, row) != b.grid.HasSnake(col, row) ||
+                    a.grid.AppleAt(col, row) != b.grid.AppleAt(col, row)) {
+                    return "occupancy grid";
+                }
+            }
+        }
+        // Spawns pick free cells by index, so their order matters too
+        if (a.grid.FreeCount() != b.grid.FreeCount()) {
+            return "free cell count";
+        }
+        for (int i = 0; i < a.grid.FreeCount(); i++) {
+            if (a.grid.FreeCell(i).col != b.grid.FreeCell(i).col || a.grid.FreeCell(i).row != b.grid.FreeCell(i).row) {
+                return "free cell order";
+            }
+        }
+        return "";
+    }
+
+    class Run {
+    public:
+        explicit Run(const Options& options) : options(options), rewind(options.seconds), rng(options.seed) {}
+
+        int Play() {
+            using Clock = std::chrono::steady_clock;
+            state.SetBoardSize(options.boardWidth, options.boardHeight);
+            state.Initialize(options.seed);
+            state.gameMode = options.mode;
+            NewGame();
+
+            for (long long i = 0; i < options.ticks; i++) {
+                if (state.gameOver) {
+                    // Retry some games from a few seconds back, start the rest over
+                    if (rng.Range(0, 2) == 0 && rewind.Available() > 0) {
+                        if (!Rewind(rng.Range(1, rewind.Available()))) {
+                            return 1;
+                        }
+                    }
+                    if (state.gameOver) {
+                        NewGame();
+                    }
+                } else if (i % REWIND_INTERVAL == 0 && rewind.Available() > 0) {
+                    if (!Rewind(rng.Range(0, rewind.Available()))) {
+                        return 1;
+                    }
+                }
+
+                Advance(state);
+                if (!state.gameOver && !state.isUserPaused) {
+                    Clock::time_point start = Clock::now();
+                    rewind.Capture(state);
+                    captureSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+                    captures++;
+                    if (options.verify) {
+                        history.push_back(state);
+                        history.back().journal = nullptr;
+                        if ((int)history.size() > options.seconds * GameConstants::TICK_RATE) {
+                            history.pop_front();
+                        }
+                        // It must never offer a tick it did not capture in this timeline
+                        if (rewind.Available() >= (int)history.size()) {
+                            std::printf("tick %u: %d ticks available, %zu captures kept\n", state.tick,
+                                        rewind.Available(), history.size());
+                            return 1;
+                        }
+                    }
+                }
+            }
+            return 0;
+        }
+
+        void Report(bool verified) const {
+            std::printf("ticks:         %lld (%s, %dx%d)\n", options.ticks,
+                        options.mode == MODE_ACCELERATED ? "accelerated" : "regular", options.boardWidth,
+                        options.boardHeight);
+            std::printf("games:         %d\n", games);
+            std::printf("capture:       %.0f ns avg\n", captures > 0 ? captureSeconds * 1e9 / captures : 0.0);
+            std::printf("rewinds:       %d, %.1f us avg\n", rewinds, rewinds > 0 ? rewindSeconds * 1e6 / rewinds : 0.0);
+            if (verified) {
+                std::printf("verified %d rewinds and %d continuations: identical\n", checks, continuations);
+            }
+        }
+
+    private:
+        void NewGame() {
+            state.Reset();
+            rewind.Attach(state);
+            history.clear();
+            games++;
+        }
+
+        // Rewinds and, with --verify, checks the result; false on a mismatch
+        bool Rewind(int ticks) {
+            using Clock = std::chrono::steady_clock;
+            Clock::time_point start = Clock::now();
+            int back = rewind.Rewind(state, ticks);
+            rewindSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+            rewinds++;
+            if (!options.verify) {
+                return true;
+            }
+
+            // The snapshot restored is `back` captures before the newest one
+            if (back >= (int)history.size()) {
+                std::printf("rewind %d (asked %d) went past the %zu captures kept\n", back, ticks, history.size());
+                return false;
+            }
+            size_t restored = history.size() - 1 - back;
+            const char* difference = Compare(state, history[restored]);
+            if (difference[0] != '\0') {
+                std::printf("rewind %d at tick %u: %s differs\n", back, history[restored].tick, difference);
+                return false;
+            }
+            checks++;
+
+            // Play a copy on from the restored state (off the journal) and
+            // compare with the capture the first run made at that tick
+            size_t later = std::min(history.size() - 1, restored + CONTINUE_TICKS);
+            if (later > restored) {
+                GameState replay = state;
+                replay.journal = nullptr;
+                while (replay.tick < history[later].tick) {
+                    Advance(replay);
+                }
+                difference = Compare(replay, history[later]);
+                if (difference[0] != '\0') {
+                    std::printf("after rewind %d, tick %u: %s differs\n", back, history[later].tick, difference);
+                    return false;
+                }
+                continuations++;
+            }
+            history.erase(history.begin() + restored + 1, history.end());
+            return true;
+        }
+
+        const Options& options;
+        GameState state;
+        RewindBuffer rewind;
+        Rng rng;                        // Rewind distances, apart from the game's own generator
+        std::deque<GameState> history;  // --verify: the state at each capture still in the buffer
+        int games = 0;
+        int rewinds = 0;
+        int checks = 0;
+        int continuations = 0;
+        long long captures = 0;
+        double captureSeconds = 0.0;
+        double rewindSeconds = 0.0;
+    };
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    // Every option takes a value
+    for (int i = 1; i < argc; i += 2) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = true;
+        if (!value) {
+            ok = false;
+        } else if (std::strcmp(arg, "--ticks") == 0) {
+            options.ticks = std::max(1LL, std::atoll(value));
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--mode") == 0) {
+            options.mode = (std::strcmp(value, "accelerated") == 0) ? MODE_ACCELERATED : MODE_REGULAR;
+        } else if (std::strcmp(arg, "--board") == 0) {
+            char* end = nullptr;
+            options.boardWidth = (int)std::strtol(value, &end, 10);
+            options.boardHeight = (*end == 'x') ? (int)std::strtol(end + 1, nullptr, 10) : options.boardWidth;
+        } else if (std::strcmp(arg, "--seconds") == 0) {
+            options.seconds = std::max(1, std::atoi(value));
+        } else if (std::strcmp(arg, "--verify") == 0) {
+            options.verify = std::atoi(value) != 0;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "Usage: %s [--ticks <n>] [--seed <n>] [--mode regular|accelerated]\n"
+                                 "       [--board <cols>x<rows>] [--seconds <n>] [--verify 1]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    Run run(options);
+    int result = run.Play();
+    run.Report(options.verify && result == 0);
+    return result;
+}
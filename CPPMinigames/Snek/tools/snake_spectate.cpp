@@ -0,0 +1,183 @@
+// Headless spectator: follows a game publishing with `snake --spectate` and
+// prints its progress once a second (optionally with the board), along with
+// how many times the stream had to resync after falling behind. With
+// --publish it plays autopilot games in real time and publishes them
+// instead, as a stand-in for the game on machines without a display.
+//
+// Usage: snake_spectate [--name <stream>] [--ascii] [--seconds <n>]
+//        snake_spectate --publish [--name <stream>] [--board <cols>x<rows>]
+//                       [--mode regular|accelerated] [--seconds <n>]
+
+#include "autopilot.h"
+#include "game_logic.h"
+#include "game_state.h"
+#include "spectator_stream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    char AppleChar(FoodType type) {
+        switch (type) {
+            case POISONOUS: return 'x';
+            case POMME_PLUS: return '+';
+            case POMME_SUPREME: return '*';
+            case TELEPORT: return '?';
+            default: return 'o';
+        }
+    }
+
+    void PrintBoard(const GameState& view) {
+        const int maxCols = 100;
+        const int maxRows = 50;
+        int cols = std::min(view.boardWidth, maxCols);
+        int rows = std::min(view.boardHeight, maxRows);
+        std::vector<std::string> lines(rows, std::string(cols, '.'));
+        for (const Apple& apple : view.apples) {
+            if (apple.col < cols && apple.row < rows) {
+                lines[apple.row][apple.col] = AppleChar(apple.type);
+            }
+        }
+        for (int i = view.snake.size() - 1; i >= 0; i--) {
+            Position cell = view.snake[i];
+            if (cell.col >= 0 && cell.col < cols && cell.row >= 0 && cell.row < rows) {
+                lines[cell.row][cell.col] = (i == 0) ? '@' : '#';
+            }
+        }
+        for (const std::string& line : lines) {
+            std::printf("%s\n", line.c_str());
+        }
+    }
+
+    int Watch(const std::string& name, bool ascii, int seconds) {
+        SpectatorReader reader;
+        GameState view;
+        Clock::time_point start = Clock::now();
+        Clock::time_point nextReport = start + std::chrono::seconds(1);
+        int records = 0;
+        bool waiting = false;
+
+        while (seconds <= 0 || Clock::now() - start < std::chrono::seconds(seconds)) {
+            if (!reader.IsAttached() || reader.WriterClosed()) {
+                if (reader.IsAttached()) {
+                    std::printf("stream closed\n");
+                    reader.Detach();
+                }
+                if (!reader.Attach(name)) {
+                    if (!waiting) {
+                        std::printf("waiting for stream '%s'\n", name.c_str());
+                        waiting = true;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+                    continue;
+                }
+                waiting = false;
+                std::printf("attached to stream '%s'\n", name.c_str());
+            }
+
+            records += reader.Poll(view);
+            if (Clock::now() >= nextReport) {
+                nextReport += std::chrono::seconds(1);
+                if (reader.Synced()) {
+                    if (ascii) {
+                        PrintBoard(view);
+                    }
+                    std::printf("tick %u  score %d  length %d  apples %zu  records/s %d  overruns %u%s\n",
+                                view.tick, view.score, view.snake.size(), view.apples.size(), records,
+                                reader.Overruns(), view.gameOver ? "  (game over)" : "");
+                }
+                records = 0;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(4));
+        }
+        return 0;
+    }
+
+    int Publish(const std::string& name, int boardWidth, int boardHeight, GameMode mode, int seconds) {
+        Rng seedSource((uint64_t)std::time(nullptr));
+        GameState state;
+        state.SetBoardSize(boardWidth, boardHeight);
+        state.Initialize(seedSource.Next());
+        // The writer builds its tick records from the board changes journalled here
+        BoardJournal journal;
+        journal.Allocate(1024);
+        state.journal = &journal;
+        SpectatorWriter writer;
+        if (!writer.Open(name, state.boardWidth, state.boardHeight)) {
+            std::fprintf(stderr, "Could not create stream '%s'\n", name.c_str());
+            return 1;
+        }
+        std::printf("publishing stream '%s'\n", name.c_str());
+
+        Autopilot autopilot;
+        state.gameMode = mode;
+        state.Reset(seedSource.Next());
+        Clock::time_point start = Clock::now();
+        Clock::duration tickLength = std::chrono::nanoseconds(1000000000 / GameConstants::TICK_RATE);
+        Clock::time_point nextTick = start;
+        uint32_t overTick = 0;
+
+        while (seconds <= 0 || Clock::now() - start < std::chrono::seconds(seconds)) {
+            // A couple of seconds on the game over screen, then the next game
+            if (state.gameOver && ++overTick > 2 * GameConstants::TICK_RATE) {
+                overTick = 0;
+                state.Reset(seedSource.Next());
+            }
+            Direction move;
+            if (autopilot.ChooseMove(state, move)) {
+                GameLogic::QueueDirection(state, move);
+            }
+            GameLogic::Step(state);
+            state.events.Clear();
+            writer.Publish(state);
+
+            nextTick += tickLength;
+            std::this_thread::sleep_until(nextTick);
+        }
+        std::printf("published %llu bytes\n", (unsigned long long)writer.BytesWritten());
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string name = "live";
+    bool publish = false;
+    bool ascii = false;
+    int seconds = 0;
+    int boardWidth = GameConstants::GRID_WIDTH;
+    int boardHeight = GameConstants::GRID_HEIGHT;
+    GameMode mode = MODE_ACCELERATED;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (std::strcmp(argv[i], "--publish") == 0) {
+            publish = true;
+        } else if (std::strcmp(argv[i], "--ascii") == 0) {
+            ascii = true;
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--board") == 0 && i + 1 < argc) {
+            char* end = nullptr;
+            boardWidth = (int)std::strtol(argv[++i], &end, 10);
+            boardHeight = (*end == 'x') ? (int)std::strtol(end + 1, nullptr, 10) : boardWidth;
+        } else if (std::strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            mode = (std::strcmp(argv[++i], "regular") == 0) ? MODE_REGULAR : MODE_ACCELERATED;
+        } else {
+            std::fprintf(stderr, "Usage: %s [--name <stream>] [--ascii] [--seconds <n>]\n"
+                                 "       %s --publish [--name <stream>] [--board <cols>x<rows>]\n"
+                                 "                    [--mode regular|accelerated] [--seconds <n>]\n",
+                         argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    return publish ? Publish(name, boardWidth, boardHeight, mode, seconds) : Watch(name, ascii, seconds);
+}
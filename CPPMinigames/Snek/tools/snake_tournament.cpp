@@ -0,0 +1,352 @@
+// Headless self-play tournament: runs many independent games across all
+// cores, each with its own seed and controller, and prints a JSON summary of
+// scores, game lengths and death causes. Used to tune the spawn weights and
+// despawn times in GameRules. With --verify 1 every move the controller
+// picks is also tried against the alternatives on a copy of the state, and
+// any move that kills the snake while another would not is counted (and
+// makes the exit code 1).
+//
+// Usage: snake_tournament [--games <n>] [--threads <n>] [--seed <n>]
+//                         [--controller autopilot|random] [--mode regular|accelerated]
+//                         [--board <cols>x<rows>] [--max-ticks <n>]
+//                         [--nodes <n>] [--budget <us>]
+//                         [--food-weights <regular,poison,plus,supreme,teleport>]
+//                         [--despawn <min,max>] [--json <file>] [--verify 1]
+
+#include "game_state.h"
+#include "game_logic.h"
+#include "autopilot.h"
+#include "controller.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Random but not suicidal: turns now and then, never straight into a wall or the body
+    class RandomController : public Controller {
+    public:
+        void NewGame(uint64_t seed) override { rng.Seed(seed ^ 0x5eedull); }
+
+        bool ChooseMove(const GameState& state, Direction& move) override {
+            if (!state.directionQueue.empty() || !GameLogic::MovesNextStep(state)) {
+                return false;
+            }
+            const Direction moves[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+            bool moving = state.dx != 0 || state.dy != 0;
+            int keep = -1;
+            int safe[4];
+            int safeCount = 0;
+            for (int dir = 0; dir < 4; dir++) {
+                if (moving && moves[dir].dx == -state.dx && moves[dir].dy == -state.dy) {
+                    continue;
+                }
+                Position next = {state.snake.front().col + moves[dir].dx, state.snake.front().row + moves[dir].dy};
+                if (state.canPassWalls) {
+                    next.col = (next.col + state.boardWidth) % state.boardWidth;
+                    next.row = (next.row + state.boardHeight) % state.boardHeight;
+                } else if (next.col < 0 || next.col >= state.boardWidth || next.row < 0 || next.row >= state.boardHeight) {
+                    continue;
+                }
+                if (!state.canIntersectSelf && state.grid.HasSnake(next.col, next.row)) {
+                    continue;
+                }
+                if (moves[dir].dx == state.dx && moves[dir].dy == state.dy) {
+                    keep = dir;
+                }
+                safe[safeCount++] = dir;
+            }
+            if (safeCount == 0) {
+                return false;
+            }
+            int dir = (keep >= 0 && rng.Range(0, 7) != 0) ? keep : safe[rng.Range(0, safeCount - 1)];
+            move = moves[dir];
+            return true;
+        }
+
+    private:
+        Rng rng;
+    };
+
+    struct Options {
+        int games = 1000;
+        int threads = 0;
+        uint64_t seed = 1;
+        std::string controller = "autopilot";
+        GameMode mode = MODE_REGULAR;
+        int boardWidth = GameConstants::GRID_WIDTH;
+        int boardHeight = GameConstants::GRID_HEIGHT;
+        uint32_t maxTicks = 3600 * GameConstants::TICK_RATE;
+        int nodes = 20000;
+        int budgetMicros = 0;       // Off by default so runs are reproducible
+        GameRules rules;
+        bool verify = false;
+    };
+
+    struct GameResult {
+        uint64_t seed;
+        int score;
+        int length;
+        uint32_t ticks;
+        DeathCause cause;
+        int avoidableDeaths;        // --verify: fatal moves chosen while a safe one existed
+    };
+
+    std::unique_ptr<Controller> MakeController(const Options& options) {
+        if (options.controller == "random") {
+            return std::unique_ptr<Controller>(new RandomController());
+        }
+        return std::unique_ptr<Controller>(new Autopilot(options.budgetMicros, options.nodes));
+    }
+
+    // Whether queueing `move` now ends the game on the next step
+    bool MoveKills(const GameState& state, Direction move) {
+        GameState trial = state;
+        GameLogic::QueueDirection(trial, move);
+        GameLogic::Step(trial);
+        return trial.gameOver;
+    }
+
+    bool SafeMoveExists(const GameState& state) {
+        const Direction moves[4] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+        for (const Direction& move : moves) {
+            if (!MoveKills(state, move)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Plays one game to the end (or the tick limit) in a state owned by the calling thread
+    GameResult PlayGame(const Options& options, uint64_t seed, GameState& state, Controller& controller) {
+        state.SetBoardSize(options.boardWidth, options.boardHeight);
+        state.rules = options.rules;
+        state.Initialize(seed);
+        state.gameMode = options.mode;
+        state.Reset(seed);
+        controller.NewGame(seed);
+
+        int avoidableDeaths = 0;
+        while (!state.gameOver && state.tick < options.maxTicks) {
+            Direction move;
+            if (controller.ChooseMove(state, move)) {
+                if (options.verify && MoveKills(state, move) && SafeMoveExists(state)) {
+                    avoidableDeaths++;
+                }
+                GameLogic::QueueDirection(state, move);
+            }
+            GameLogic::Step(state);
+        }
+        return {seed, state.score, state.snake.size(), state.tick, state.deathCause, avoidableDeaths};
+    }
+
+    bool ParseInts(const char* text, int* values, int count) {
+        for (int i = 0; i < count; i++) {
+            char* end = nullptr;
+            values[i] = (int)std::strtol(text, &end, 10);
+            if (end == text || (i + 1 < count && *end != ',')) {
+                return false;
+            }
+            text = end + 1;
+        }
+        return true;
+    }
+
+    // Percentile of an ascending list (nearest rank)
+    template <typename T>
+    T Percentile(const std::vector<T>& sorted, double p) {
+        size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+        return sorted[rank > 0 ? rank - 1 : 0];
+    }
+
+    template <typename T>
+    void WriteDistribution(FILE* out, const char* name, std::vector<T> values, bool histogram) {
+        std::sort(values.begin(), values.end());
+        double mean = 0.0;
+        for (T v : values) {
+            mean += (double)v;
+        }
+        mean /= values.size();
+        double variance = 0.0;
+        for (T v : values) {
+            variance += ((double)v - mean) * ((double)v - mean);
+        }
+        variance /= values.size();
+
+        std::fprintf(out, "  \"%s\": {\"mean\": %.3f, \"stddev\": %.3f, \"min\": %.0f, \"p10\": %.0f, \"p25\": %.0f, "
+                     "\"p50\": %.0f, \"p75\": %.0f, \"p90\": %.0f, \"p99\": %.0f, \"max\": %.0f",
+                     name, mean, std::sqrt(variance), (double)values.front(),
+                     (double)Percentile(values, 10), (double)Percentile(values, 25), (double)Percentile(values, 50),
+                     (double)Percentile(values, 75), (double)Percentile(values, 90), (double)Percentile(values, 99),
+                     (double)values.back());
+
+        // Up to 20 equal-width buckets starting at 0
+        if (histogram) {
+            const int maxBuckets = 20;
+            long long top = (long long)values.back();
+            long long width = std::max(1LL, (top + maxBuckets) / maxBuckets);
+            std::vector<int> counts((size_t)(top / width) + 1, 0);
+            for (T v : values) {
+                counts[(size_t)((long long)v / width)]++;
+            }
+            std::fprintf(out, ", \"histogram\": {\"bucket_width\": %lld, \"counts\": [", width);
+            for (size_t i = 0; i < counts.size(); i++) {
+                std::fprintf(out, "%s%d", i ? ", " : "", counts[i]);
+            }
+            std::fprintf(out, "]}");
+        }
+        std::fprintf(out, "}");
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    const char* jsonPath = nullptr;
+    // Every option takes a value
+    for (int i = 1; i < argc; i += 2) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = true;
+        if (!value) {
+            ok = false;
+        } else if (std::strcmp(arg, "--games") == 0) {
+            options.games = std::max(1, std::atoi(value));
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            options.threads = std::max(0, std::atoi(value));
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--controller") == 0) {
+            options.controller = value;
+            ok = options.controller == "autopilot" || options.controller == "random";
+        } else if (std::strcmp(arg, "--mode") == 0) {
+            options.mode = (std::strcmp(value, "accelerated") == 0) ? MODE_ACCELERATED : MODE_REGULAR;
+        } else if (std::strcmp(arg, "--board") == 0) {
+            char* end = nullptr;
+            options.boardWidth = (int)std::strtol(value, &end, 10);
+            options.boardHeight = (*end == 'x') ? (int)std::strtol(end + 1, nullptr, 10) : options.boardWidth;
+        } else if (std::strcmp(arg, "--max-ticks") == 0) {
+            options.maxTicks = (uint32_t)std::strtoul(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--nodes") == 0) {
+            options.nodes = std::atoi(value);
+        } else if (std::strcmp(arg, "--budget") == 0) {
+            options.budgetMicros = std::atoi(value);
+        } else if (std::strcmp(arg, "--food-weights") == 0) {
+            ok = ParseInts(value, options.rules.foodWeights, 5);
+        } else if (std::strcmp(arg, "--despawn") == 0) {
+            int range[2];
+            ok = ParseInts(value, range, 2) && range[0] > 0 && range[0] <= range[1];
+            options.rules.despawnTimeMin = range[0];
+            options.rules.despawnTimeMax = range[1];
+        } else if (std::strcmp(arg, "--json") == 0) {
+            jsonPath = value;
+        } else if (std::strcmp(arg, "--verify") == 0) {
+            options.verify = std::atoi(value) != 0;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "Bad or unknown option %s (see the usage at the top of snake_tournament.cpp)\n", arg);
+            return 1;
+        }
+    }
+
+    int threadCount = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+    threadCount = std::max(1, std::min(threadCount, options.games));
+
+    // Seeds are fixed up front, so results don't depend on the thread count
+    std::vector<uint64_t> seeds(options.games);
+    Rng seedSource(options.seed);
+    for (uint64_t& seed : seeds) {
+        seed = seedSource.Next();
+    }
+
+    // Each thread owns its state and controller and writes only its own result
+    // slots; the only thing shared is the counter handing out game indices
+    std::vector<GameResult> results(options.games);
+    std::atomic<int> nextGame(0);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.emplace_back([&]() {
+            GameState state;
+            std::unique_ptr<Controller> controller = MakeController(options);
+            for (int i = nextGame++; i < options.games; i = nextGame++) {
+                results[i] = PlayGame(options, seeds[i], state, *controller);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int> scores;
+    std::vector<int> lengths;
+    std::vector<uint32_t> ticks;
+    int causes[5] = {};
+    uint64_t totalTicks = 0;
+    int avoidableDeaths = 0;
+    const GameResult* firstAvoidable = nullptr;
+    for (const GameResult& result : results) {
+        avoidableDeaths += result.avoidableDeaths;
+        if (result.avoidableDeaths > 0 && !firstAvoidable) {
+            firstAvoidable = &result;
+        }
+        scores.push_back(result.score);
+        lengths.push_back(result.length);
+        ticks.push_back(result.ticks);
+        causes[result.cause]++;
+        totalTicks += result.ticks;
+    }
+
+    FILE* out = stdout;
+    if (jsonPath) {
+        out = std::fopen(jsonPath, "w");
+        if (!out) {
+            std::fprintf(stderr, "Could not write %s\n", jsonPath);
+            return 1;
+        }
+    }
+    const GameRules& rules = options.rules;
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"games\": %d,\n  \"threads\": %d,\n  \"seed\": %llu,\n", options.games, threadCount,
+                 (unsigned long long)options.seed);
+    std::fprintf(out, "  \"controller\": \"%s\",\n  \"mode\": \"%s\",\n  \"board\": {\"width\": %d, \"height\": %d},\n",
+                 options.controller.c_str(), options.mode == MODE_ACCELERATED ? "accelerated" : "regular",
+                 options.boardWidth, options.boardHeight);
+    std::fprintf(out, "  \"max_ticks\": %u,\n", options.maxTicks);
+    std::fprintf(out, "  \"rules\": {\"food_weights\": {\"regular\": %d, \"poison\": %d, \"pomme_plus\": %d, "
+                 "\"pomme_supreme\": %d, \"teleport\": %d}, \"despawn_seconds\": [%d, %d]},\n",
+                 rules.foodWeights[REGULAR], rules.foodWeights[POISONOUS], rules.foodWeights[POMME_PLUS],
+                 rules.foodWeights[POMME_SUPREME], rules.foodWeights[TELEPORT], rules.despawnTimeMin, rules.despawnTimeMax);
+    WriteDistribution(out, "score", scores, true);
+    std::fprintf(out, ",\n");
+    WriteDistribution(out, "length", lengths, true);
+    std::fprintf(out, ",\n");
+    WriteDistribution(out, "ticks", ticks, false);
+    std::fprintf(out, ",\n");
+    std::fprintf(out, "  \"deaths\": {\"wall\": %d, \"self\": %d, \"teleport_trap\": %d, \"quit\": %d, \"timeout\": %d},\n",
+                 causes[DEATH_WALL], causes[DEATH_SELF], causes[DEATH_TELEPORT_TRAP], causes[DEATH_QUIT], causes[DEATH_NONE]);
+    std::fprintf(out, "  \"seconds\": %.3f,\n  \"games_per_second\": %.1f,\n  \"ticks_per_second\": %.0f\n}\n",
+                 seconds, options.games / seconds, totalTicks / seconds);
+    if (jsonPath) {
+        std::fclose(out);
+    }
+
+    if (options.verify) {
+        std::fprintf(stderr, "verify: %d avoidable fatal moves", avoidableDeaths);
+        if (firstAvoidable) {
+            std::fprintf(stderr, " (first in the game with seed %llu)", (unsigned long long)firstAvoidable->seed);
+        }
+        std::fprintf(stderr, "\n");
+        return avoidableDeaths > 0 ? 1 : 0;
+    }
+    return 0;
+}